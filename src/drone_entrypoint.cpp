@@ -1,6 +1,12 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 
 #include "flight_data/drone_flight_data.h"
+#include "flight_data/fleet_session.h"
+#include "flight_data/live_flight_data.h"
 #include "glfw/glfw.h"
 #include "glfw/glfw_surface.h"
 #include "visualizer.h"
@@ -10,35 +16,87 @@ void setupInput(dfv::raii::Glfw &glfw, dfv::Visualizer &visualizer);
 /*
  * The main entrypoint of the drone flight visualizer.
  *
- * Command line usage: drone_flight_visualizer $1
+ * Command line usage: drone_flight_visualizer [options] $1 [$2...]
  * $1: Drone CSV flight_data
+ * $2...: Other drone CSV flight data, shown alongside the first one with its start time aligned to it
+ * Options:
+ *   --legacy-reader: parse the CSV with the generic CSV reader instead of the memory-mapped parser
+ *   --threads N: parse the CSV with N threads, defaults to all hardware threads
+ *   --no-cache: don't load from or write to the binary flight cache (.dfvbin) next to the CSV
+ *   --progressive: start the visualization as soon as the first rows are parsed, loading the rest in the background
+ *   --live: follow a CSV that is still being written (or a named pipe), showing the flight as it progresses
+ *   --compress: keep the flight path delta-compressed in memory, for very long logs
+ *   --compare [N]: align the path of every other flight to the first one, matching samples at most N apart (default 64)
  */
 int main(const int argc, char **argv) {
-    std::filesystem::path path;
-    if (argc > 1) {
-        path = argv[1];
-
-        // Warn about extra arguments
-        if (argc > 2) {
-            std::cout << "Unused arguments: ";
-            for (int i = 2; i < argc; i++)
-                std::cout << std::format("'{}' ", argv[i]);
-        }
-    } else {
-        std::cout << "Usage: drone_flight_visualizer $1\n"
-                  << "$1: Drone CSV data filepath" << std::endl;
+    std::vector<std::filesystem::path> paths;
+    dfv::DroneFlightDataOptions options{};
+    bool live = false;
+    size_t alignmentBand = 0;
+
+    std::vector<std::string> unusedArgs;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--legacy-reader")
+            options.legacyReader = true;
+        else if (arg == "--no-cache")
+            options.useCache = false;
+        else if (arg == "--progressive")
+            options.progressive = true;
+        else if (arg == "--live")
+            live = true;
+        else if (arg == "--compress")
+            options.compressPath = true;
+        else if (arg == "--compare") {
+            alignmentBand = 64;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                alignmentBand = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--threads" && i + 1 < argc)
+            options.parserThreads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!arg.starts_with("--"))
+            paths.emplace_back(arg);
+        else
+            unusedArgs.emplace_back(arg);
+    }
+
+    // Warn about extra arguments
+    if (!unusedArgs.empty()) {
+        std::cout << "Unused arguments: ";
+        for (const auto &arg : unusedArgs)
+            std::cout << std::format("'{}' ", arg);
+        std::cout << std::endl;
+    }
+
+    if (paths.empty() || (live && paths.size() > 1)) {
+        std::cout << "Usage: drone_flight_visualizer [options] $1 [$2...]\n"
+                  << "$1: Drone CSV data filepath\n"
+                  << "$2...: Other drone CSV data filepaths, loaded concurrently and shown alongside the first one\n"
+                  << "Options:\n"
+                  << "  --legacy-reader: parse the CSV with the generic CSV reader\n"
+                  << "  --threads N: parse the CSV with N threads, defaults to all hardware threads\n"
+                  << "  --no-cache: don't use the binary flight cache next to the CSV\n"
+                  << "  --progressive: start the visualization while the rest of the CSV is loaded\n"
+                  << "  --live: follow a CSV that is still being written, or a named pipe, only one can be followed\n"
+                  << "  --compress: keep the flight path compressed in memory, for very long logs\n"
+                  << "  --compare [N]: align every other flight to the first one, matching samples at most N apart" << std::endl;
         return 1;
     }
 
     // Initialize the flight data object
-    dfv::DroneFlightData data{path};
+    std::unique_ptr<dfv::FlightData> data;
+    if (live)
+        data = std::make_unique<dfv::LiveFlightData>(paths.front());
+    else if (paths.size() > 1)
+        data = std::make_unique<dfv::FleetSession>(paths, options, alignmentBand);
+    else
+        data = std::make_unique<dfv::DroneFlightData>(paths.front(), options);
 
     // GLFW initialization
     dfv::raii::Glfw glfw{"Drone Flight Visualizer"};
     dfv::GlfwSurface surface{glfw.window()};
 
     const dfv::VisualizerCreateInfo createInfo{.surface = surface,
-                                               .flightData = data,
+                                               .flightData = *data,
                                                .droneModelPath = "assets/models/model.obj",
                                                .droneScale = 0.04f};
 
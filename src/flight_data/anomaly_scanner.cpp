@@ -0,0 +1,244 @@
+#include "anomaly_scanner.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <thread>
+
+#include "geo_types.h"
+#include "interpolation.h"
+
+namespace dfv {
+    namespace {
+        constexpr size_t BlockSize = 1024; //!< The number of steps transposed and tested at once, sized to stay in L1
+        constexpr size_t MinChunkSize = 1 << 16; //!< The fewest steps scanned by each thread
+        constexpr size_t TypeCount = AnomalyTypeCount;
+
+        /**
+         * @brief A block of samples transposed to one array per field, the first entry is the sample before the block.
+         */
+        struct Block {
+            std::array<float, BlockSize + 1> timestamp;
+            std::array<float, BlockSize + 1> x;
+            std::array<float, BlockSize + 1> y;
+            std::array<float, BlockSize + 1> z;
+            std::array<float, BlockSize + 1> yaw;
+            std::array<float, BlockSize + 1> pitch;
+            std::array<float, BlockSize + 1> roll;
+            std::array<uint8_t, BlockSize + 1> flags; //!< One bit per AnomalyType for each step ending at the sample
+        };
+
+        /**
+         * @brief A run of anomalous steps, identified by the samples ending its first and last steps.
+         */
+        struct Run {
+            FlightAnomaly anomaly;
+            size_t first;
+            size_t last;
+        };
+
+        uint8_t flagBit(const AnomalyType type) {
+            return static_cast<uint8_t>(1u << static_cast<unsigned int>(type));
+        }
+
+        /**
+         * @brief Returns the fastest of the yaw, pitch and roll rates of the step ending at sample i of the block.
+         */
+        inline float attitudeRate(const Block &block, const size_t i, const float invDt) {
+            const float yawRate = std::abs(wrapAngle(block.yaw[i] - block.yaw[i - 1]));
+            const float pitchRate = std::abs(wrapAngle(block.pitch[i] - block.pitch[i - 1]));
+            const float rollRate = std::abs(wrapAngle(block.roll[i] - block.roll[i - 1]));
+            return std::max(yawRate, std::max(pitchRate, rollRate)) * invDt;
+        }
+
+        /**
+         * @brief Tests the steps ending at samples [1, count] of the block for every anomaly at once.
+         * @details Compares squared speeds to leave the square roots to the rare flagged steps.
+         */
+        void flagKernel(Block &block, const size_t count, const AnomalyThresholds &thresholds, const UnitScale scale) {
+            const float maxSpeedSquared = thresholds.maxSpeed * thresholds.maxSpeed;
+            for (size_t i = 1; i <= count; i++) {
+                const float dt = block.timestamp[i] - block.timestamp[i - 1];
+                const float invDt = safeReciprocal(dt);
+
+                // The positions are in units, the speed threshold in meters per second
+                const float dx = (block.x[i] - block.x[i - 1]) * scale.east;
+                const float dz = (block.z[i] - block.z[i - 1]) * scale.north;
+                const float speedSquared = (dx * dx + dz * dz) * invDt * invDt;
+                const float descentRate = (block.y[i - 1] - block.y[i]) * invDt;
+
+                const auto drop = static_cast<uint8_t>(descentRate > thresholds.maxDescentRate);
+                const auto spike = static_cast<uint8_t>(attitudeRate(block, i, invDt) > thresholds.maxAttitudeRate);
+                const auto jump = static_cast<uint8_t>(speedSquared > maxSpeedSquared);
+                const auto gap = static_cast<uint8_t>(dt > thresholds.maxGap);
+                block.flags[i] = static_cast<uint8_t>(drop | spike << 1 | jump << 2 | gap << 3);
+            }
+        }
+
+        float measure(const Block &block, const size_t i, const AnomalyType type, const UnitScale scale) {
+            const float dt = block.timestamp[i] - block.timestamp[i - 1];
+            const float invDt = safeReciprocal(dt);
+            switch (type) {
+                case AnomalyType::AltitudeDrop:
+                    return (block.y[i - 1] - block.y[i]) * invDt;
+                case AnomalyType::AttitudeSpike:
+                    return attitudeRate(block, i, invDt);
+                case AnomalyType::GpsJump:
+                    return horizontalDistance(block.x[i] - block.x[i - 1], block.z[i] - block.z[i - 1], scale) * invDt;
+                case AnomalyType::SampleGap:
+                    return dt;
+            }
+            return 0.f;
+        }
+
+        /**
+         * @brief Scans the steps ending at samples [first, last), appending the runs they form in sample order per type.
+         * @note first must be at least 1.
+         */
+        void scanRange(std::span<const FlightDataPoint> points, const AnomalyThresholds &thresholds, const UnitScale scale,
+                       const size_t first, const size_t last, std::vector<Run> &runs) {
+            Block block;
+            std::array<std::optional<Run>, TypeCount> open{};
+
+            for (size_t begin = first; begin < last; begin += BlockSize) {
+                const size_t count = std::min(BlockSize, last - begin);
+
+                // Transpose the block and the sample before it, the only access to the points
+                for (size_t j = 0; j <= count; j++) {
+                    const auto &point = points[begin - 1 + j];
+                    block.timestamp[j] = point.timestamp;
+                    block.x[j] = point.x;
+                    block.y[j] = point.y;
+                    block.z[j] = point.z;
+                    block.yaw[j] = point.yaw;
+                    block.pitch[j] = point.pitch;
+                    block.roll[j] = point.roll;
+                }
+
+                flagKernel(block, count, thresholds, scale);
+
+                for (size_t j = 1; j <= count; j++) {
+                    if (block.flags[j] == 0)
+                        continue;
+
+                    const size_t sample = begin - 1 + j;
+                    for (size_t type = 0; type < TypeCount; type++) {
+                        const auto anomalyType = static_cast<AnomalyType>(type);
+                        if (!(block.flags[j] & flagBit(anomalyType)))
+                            continue;
+
+                        const float value = measure(block, j, anomalyType, scale);
+                        auto &run = open[type];
+                        if (run && run->last + 1 == sample) {
+                            run->last = sample;
+                            run->anomaly.endTime = block.timestamp[j];
+                            run->anomaly.peak = std::max(run->anomaly.peak, value);
+                            continue;
+                        }
+
+                        if (run)
+                            runs.push_back(*run);
+                        run = Run{.anomaly = {.type = anomalyType,
+                                              .startTime = block.timestamp[j - 1],
+                                              .endTime = block.timestamp[j],
+                                              .peak = value},
+                                  .first = sample,
+                                  .last = sample};
+                    }
+                }
+            }
+
+            for (auto &run : open) {
+                if (run)
+                    runs.push_back(*run);
+            }
+        }
+    } // namespace
+
+    std::string_view anomalyName(const AnomalyType type) {
+        switch (type) {
+            case AnomalyType::AltitudeDrop:
+                return "Altitude drop";
+            case AnomalyType::AttitudeSpike:
+                return "Attitude spike";
+            case AnomalyType::GpsJump:
+                return "GPS jump";
+            case AnomalyType::SampleGap:
+                return "Sample gap";
+        }
+        return "Unknown";
+    }
+
+    std::vector<FlightAnomaly> scanAnomalies(std::span<const FlightDataPoint> points, const double originLatitude,
+                                             const AnomalyThresholds &thresholds, unsigned int threadCount) {
+        if (points.size() < 2)
+            return {};
+
+        const UnitScale scale = unitScaleAt(originLatitude);
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t stepCount = points.size() - 1;
+        const size_t chunkCount = std::clamp<size_t>(stepCount / MinChunkSize, 1, threadCount);
+
+        std::vector<std::future<std::vector<Run>>> chunkFutures;
+        chunkFutures.reserve(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            const size_t first = 1 + stepCount * chunk / chunkCount;
+            const size_t last = 1 + stepCount * (chunk + 1) / chunkCount;
+            chunkFutures.push_back(std::async(std::launch::async, [points, &thresholds, scale, first, last] {
+                std::vector<Run> runs;
+                scanRange(points, thresholds, scale, first, last, runs);
+                return runs;
+            }));
+        }
+
+        std::vector<Run> runs;
+        for (auto &future : chunkFutures) {
+            auto chunkRuns = future.get();
+            runs.insert(runs.end(), chunkRuns.begin(), chunkRuns.end());
+        }
+
+        // Runs of each type are in sample order, those cut by a chunk boundary are joined back together
+        std::stable_sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) { return a.anomaly.type < b.anomaly.type; });
+        std::vector<FlightAnomaly> anomalies;
+        anomalies.reserve(runs.size());
+        for (size_t i = 0; i < runs.size(); i++) {
+            Run run = runs[i];
+            while (i + 1 < runs.size() && runs[i + 1].anomaly.type == run.anomaly.type && runs[i + 1].first == run.last + 1) {
+                i++;
+                run.last = runs[i].last;
+                run.anomaly.endTime = runs[i].anomaly.endTime;
+                run.anomaly.peak = std::max(run.anomaly.peak, runs[i].anomaly.peak);
+            }
+            anomalies.push_back(run.anomaly);
+        }
+
+        std::stable_sort(anomalies.begin(), anomalies.end(), [](const FlightAnomaly &a, const FlightAnomaly &b) {
+            return a.startTime < b.startTime;
+        });
+        return anomalies;
+    }
+
+    AnomalyIndex::AnomalyIndex(std::span<const FlightAnomaly> anomalies) {
+        for (const auto &anomaly : anomalies)
+            byType[static_cast<size_t>(anomaly.type)].push_back(anomaly);
+    }
+
+    const FlightAnomaly *AnomalyIndex::activeAt(const float time) const {
+        const FlightAnomaly *active = nullptr;
+        for (const auto &anomalies : byType) {
+            const auto started = std::upper_bound(anomalies.begin(), anomalies.end(), time,
+                                                  [](const float t, const FlightAnomaly &anomaly) { return t < anomaly.startTime; });
+            if (started == anomalies.begin())
+                continue;
+
+            const FlightAnomaly &latest = *std::prev(started);
+            if (latest.endTime >= time && (!active || latest.startTime > active->startTime))
+                active = &latest;
+        }
+        return active;
+    }
+} // namespace dfv
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <numbers>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief The limits beyond which a step between two samples is anomalous.
+     * @details Each anomaly is measured on every step from a sample to the next, and its peak is the largest measure
+     * over the run of anomalous steps.
+     */
+    struct AnomalyThresholds {
+        float maxDescentRate = 15.f; //!< AltitudeDrop measure: the descent rate in m/s
+        float maxAttitudeRate = 360.f * std::numbers::pi_v<float> / 180.f; //!< AttitudeSpike measure: the fastest of the yaw, pitch and roll rates in rad/s
+        float maxSpeed = 40.f; //!< GpsJump measure: the horizontal speed in m/s
+        float maxGap = 1.f; //!< SampleGap measure: the time between the samples in seconds
+    };
+
+    constexpr size_t AnomalyTypeCount = 4; //!< The number of values of AnomalyType
+
+    /**
+     * @brief Returns a short human-readable name for the given anomaly type.
+     */
+    std::string_view anomalyName(AnomalyType type);
+
+    /**
+     * @brief Scans a flight path for anomalies.
+     * @param points The path, sorted by timestamp.
+     * @param originLatitude The latitude the path is relative to, which sets the meters per unit of the positions.
+     * @param threadCount The number of threads the path is split across, 0 to use all hardware threads.
+     * @details The path is streamed in small blocks that are transposed to arrays and tested for every anomaly at
+     * once by branch-free loops the compiler vectorizes, which leaves only the rare anomalous steps to be handled one
+     * by one. Consecutive anomalous steps of the same type are merged into a single anomaly.
+     * @return The anomalies sorted by start time, those of different types may overlap.
+     */
+    std::vector<FlightAnomaly> scanAnomalies(std::span<const FlightDataPoint> points, double originLatitude,
+                                             const AnomalyThresholds &thresholds = {}, unsigned int threadCount = 0);
+
+    /**
+     * @brief Finds the anomaly going on at a given time, for showing it during playback.
+     * @details Runs of the same type never overlap, so the anomalies are split by type and the only one of each type
+     * that can be going on is the last to have started, found by a binary search on the start times.
+     */
+    class AnomalyIndex {
+      public:
+        AnomalyIndex() = default;
+
+        /**
+         * @param anomalies The anomalies sorted by start time, as returned by scanAnomalies().
+         */
+        explicit AnomalyIndex(std::span<const FlightAnomaly> anomalies);
+
+        /**
+         * @brief Returns the latest anomaly to have started that is still going on at the given time.
+         * @return The anomaly, valid for the lifetime of the index, or null if there is none.
+         */
+        const FlightAnomaly *activeAt(float time) const;
+
+      private:
+        std::array<std::vector<FlightAnomaly>, AnomalyTypeCount> byType; //!< Sorted by start time, without overlaps
+    };
+} // namespace dfv
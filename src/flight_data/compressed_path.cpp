@@ -0,0 +1,312 @@
+#include "compressed_path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "interpolation.h"
+
+namespace dfv {
+    namespace {
+        // Fixed-point steps of each field, in the order of FlightDataPoint
+        constexpr std::array<double, 7> FieldScales = {1e3, 1e3, 1e3, 1e3, 1e4, 1e4, 1e4};
+
+        std::array<float, 7> toFields(const FlightDataPoint &point) {
+            return {point.timestamp, point.x, point.y, point.z, point.yaw, point.pitch, point.roll};
+        }
+
+        FlightDataPoint toPoint(const std::array<int64_t, 7> &values) {
+            std::array<float, 7> fields;
+            for (size_t i = 0; i < fields.size(); i++)
+                fields[i] = static_cast<float>(static_cast<double>(values[i]) / FieldScales[i]);
+
+            return {.timestamp = fields[0], .x = fields[1], .y = fields[2], .z = fields[3],
+                    .yaw = fields[4], .pitch = fields[5], .roll = fields[6]};
+        }
+
+        /**
+         * @brief Maps signed integers to unsigned ones so that values close to zero stay small: 0, -1, 1, -2, 2...
+         */
+        inline uint64_t zigzagEncode(const int64_t value) {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        inline int64_t zigzagDecode(const uint64_t value) {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        /**
+         * @brief Appends the value 7 bits at a time, with the high bit of each byte set if more bytes follow.
+         */
+        void writeVarint(std::vector<uint8_t> &data, uint64_t value) {
+            while (value >= 0x80) {
+                data.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            data.push_back(static_cast<uint8_t>(value));
+        }
+
+        /**
+         * @brief The rates of change between two consecutive samples, derived as FlightTrack does.
+         */
+        struct SampleRates {
+            float groundSpeed;
+            float verticalSpeed;
+            float headingRate;
+        };
+
+        SampleRates sampleRates(const FlightDataPoint &previous, const FlightDataPoint &current, const UnitScale scale) {
+            const float invDt = safeReciprocal(current.timestamp - previous.timestamp);
+            return {.groundSpeed = horizontalDistance(current.x - previous.x, current.z - previous.z, scale) * invDt,
+                    .verticalSpeed = (current.y - previous.y) * invDt,
+                    .headingRate = wrapAngle(current.yaw - previous.yaw) * invDt};
+        }
+
+        /**
+         * @return The 3D length of the step between two samples, in meters.
+         */
+        float stepLength(const FlightDataPoint &previous, const FlightDataPoint &current, const UnitScale scale) {
+            const float horizontal = horizontalDistance(current.x - previous.x, current.z - previous.z, scale);
+            const float dy = current.y - previous.y;
+            return std::sqrt(horizontal * horizontal + dy * dy);
+        }
+
+        inline uint64_t readVarint(const uint8_t *&cursor) {
+            uint64_t value = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = *cursor++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            return value;
+        }
+    } // namespace
+
+    CompressedPath::CompressedPath(std::span<const FlightDataPoint> points, const double originLatitude)
+        : sampleCount(points.size()), unitScale(unitScaleAt(originLatitude)) {
+        const size_t blockCount = (points.size() + BlockSize - 1) / BlockSize;
+        blockTimestamps.reserve(blockCount);
+        blockKeys.reserve(blockCount);
+        blockOffsets.reserve(blockCount);
+        blockDistances.reserve(blockCount);
+        // Typical logs take about 2 bytes per field
+        data.reserve(points.size() * FieldCount * 2);
+
+        QuantizedPoint previous{};
+        FlightDataPoint previousDecoded{};
+        float distance = 0.f;
+        for (size_t i = 0; i < points.size(); i++) {
+            const auto fields = toFields(points[i]);
+
+            QuantizedPoint quantized;
+            for (size_t field = 0; field < FieldCount; field++) {
+                const double value = std::round(static_cast<double>(fields[field]) * FieldScales[field]);
+                if (!(std::abs(value) <= std::numeric_limits<int32_t>::max()))
+                    throw std::runtime_error("Flight data point " + std::to_string(i) + " is out of range for compression");
+                quantized[field] = static_cast<int32_t>(value);
+            }
+
+            // Distances are accumulated over the decoded samples, so that they agree with the channels derived from them
+            const auto decoded = toPoint({quantized[0], quantized[1], quantized[2], quantized[3], quantized[4], quantized[5], quantized[6]});
+            if (i > 0)
+                distance += stepLength(previousDecoded, decoded, unitScale);
+            previousDecoded = decoded;
+
+            if (i % BlockSize == 0) {
+                if (data.size() > std::numeric_limits<uint32_t>::max())
+                    throw std::runtime_error("Flight data is too large for compression");
+
+                blockKeys.push_back(quantized);
+                blockOffsets.push_back(static_cast<uint32_t>(data.size()));
+                // Searched with the decoded timestamp, so that it agrees with the samples of the decoded block
+                blockTimestamps.push_back(keyPoint(blockKeys.size() - 1).timestamp);
+                blockDistances.push_back(distance);
+            } else {
+                for (size_t field = 0; field < FieldCount; field++)
+                    writeVarint(data, zigzagEncode(static_cast<int64_t>(quantized[field]) - previous[field]));
+            }
+            previous = quantized;
+        }
+
+        if (!points.empty())
+            lastTimestamp = static_cast<float>(static_cast<double>(previous[0]) / FieldScales[0]);
+        data.shrink_to_fit();
+    }
+
+    size_t CompressedPath::size() const {
+        return sampleCount;
+    }
+
+    bool CompressedPath::empty() const {
+        return sampleCount == 0;
+    }
+
+    size_t CompressedPath::encodedSize() const {
+        return data.size() + blockTimestamps.size() * sizeof(float) + blockKeys.size() * sizeof(QuantizedPoint) +
+               blockOffsets.size() * sizeof(uint32_t) + blockDistances.size() * sizeof(float);
+    }
+
+    float CompressedPath::startTime() const {
+        return blockTimestamps.front();
+    }
+
+    float CompressedPath::endTime() const {
+        return lastTimestamp;
+    }
+
+    FlightDataPoint CompressedPath::keyPoint(const size_t block) const {
+        const auto &key = blockKeys[block];
+        return toPoint({key[0], key[1], key[2], key[3], key[4], key[5], key[6]});
+    }
+
+    size_t CompressedPath::blockLength(const size_t block) const {
+        return std::min(BlockSize, sampleCount - block * BlockSize);
+    }
+
+    void CompressedPath::decodeBlock(const size_t block, std::span<FlightDataPoint> points) const {
+        std::array<int64_t, FieldCount> values;
+        std::copy(blockKeys[block].begin(), blockKeys[block].end(), values.begin());
+        points[0] = keyPoint(block);
+
+        const uint8_t *cursor = data.data() + blockOffsets[block];
+        const size_t length = blockLength(block);
+        for (size_t i = 1; i < length; i++) {
+            for (size_t field = 0; field < FieldCount; field++)
+                values[field] += zigzagDecode(readVarint(cursor));
+            points[i] = toPoint(values);
+        }
+    }
+
+    std::span<const FlightDataPoint> CompressedPath::cachedBlock(const size_t block) {
+        useCounter++;
+
+        auto *entry = &cache.front();
+        for (auto &cached : cache) {
+            if (cached.block == block) {
+                cached.lastUse = useCounter;
+                return {cached.points.data(), blockLength(block)};
+            }
+            if (cached.lastUse < entry->lastUse)
+                entry = &cached;
+        }
+
+        decodeBlock(block, entry->points);
+        entry->block = block;
+        entry->lastUse = useCounter;
+        return {entry->points.data(), blockLength(block)};
+    }
+
+    size_t CompressedPath::findBlock(const float timestamp, const PlaybackCursor &cursor) const {
+        const size_t blockCount = blockTimestamps.size();
+
+        // Playback mostly stays in the same block or moves to the next one
+        const size_t cursorBlock = std::min(cursor.segment / BlockSize, blockCount - 1);
+        for (size_t block = cursorBlock; block < std::min(cursorBlock + 2, blockCount); block++) {
+            if (blockTimestamps[block] <= timestamp && (block + 1 == blockCount || timestamp < blockTimestamps[block + 1]))
+                return block;
+        }
+
+        const auto it = std::upper_bound(blockTimestamps.begin(), blockTimestamps.end(), timestamp);
+        return it == blockTimestamps.begin() ? 0 : static_cast<size_t>(std::distance(blockTimestamps.begin(), it)) - 1;
+    }
+
+    size_t CompressedPath::findSample(const float timestamp, PlaybackCursor &cursor) {
+        const size_t block = findBlock(timestamp, cursor);
+        const auto points = cachedBlock(block);
+
+        // The last sample of the block at or before the timestamp, only the first block has none
+        const auto it = std::upper_bound(points.begin(), points.end(), timestamp, [](const float time, const FlightDataPoint &point) {
+            return time < point.timestamp;
+        });
+        const size_t index = it == points.begin() ? 0 : static_cast<size_t>(std::distance(points.begin(), it)) - 1;
+        cursor.segment = block * BlockSize + index;
+        return cursor.segment;
+    }
+
+    FlightDataPoint CompressedPath::sample(const size_t index) {
+        const size_t block = index / BlockSize;
+        const size_t offset = index % BlockSize;
+
+        // The first sample of a block is in the seek table, reading it doesn't decode the block
+        if (offset == 0)
+            return keyPoint(block);
+        return cachedBlock(block)[offset];
+    }
+
+    FlightDataPoint CompressedPath::interpolate(const float timestamp, PlaybackCursor &cursor) {
+        if (empty())
+            return {timestamp, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+
+        const size_t index = findSample(timestamp, cursor);
+        const FlightDataPoint start = sample(index);
+        const FlightDataPoint end = index + 1 < sampleCount ? sample(index + 1) : start;
+
+        const float span = end.timestamp - start.timestamp;
+        const float t = span > 0.f ? std::clamp((timestamp - start.timestamp) / span, 0.f, 1.f) : 0.f;
+        return {.timestamp = timestamp,
+                .x = lerp(start.x, end.x, t),
+                .y = lerp(start.y, end.y, t),
+                .z = lerp(start.z, end.z, t),
+                .yaw = lerpAngle(start.yaw, end.yaw, t),
+                .pitch = lerpAngle(start.pitch, end.pitch, t),
+                .roll = lerpAngle(start.roll, end.roll, t)};
+    }
+
+    DerivedChannels CompressedPath::sampleChannels(const size_t index) {
+        // The first sample has nothing to derive from
+        if (index == 0)
+            return {};
+
+        const FlightDataPoint current = sample(index);
+        const FlightDataPoint previous = sample(index - 1);
+        const auto rates = sampleRates(previous, current, unitScale);
+        const auto previousRates = index >= 2 ? sampleRates(sample(index - 2), previous, unitScale) : SampleRates{};
+
+        const float speed = std::sqrt(rates.groundSpeed * rates.groundSpeed + rates.verticalSpeed * rates.verticalSpeed);
+        const float previousSpeed = std::sqrt(previousRates.groundSpeed * previousRates.groundSpeed +
+                                              previousRates.verticalSpeed * previousRates.verticalSpeed);
+
+        // The distance up to the start of the block is stored, the steps within it are added up
+        const size_t block = index / BlockSize;
+        const auto points = cachedBlock(block);
+        float distance = blockDistances[block];
+        for (size_t i = 1; i <= index % BlockSize; i++)
+            distance += stepLength(points[i - 1], points[i], unitScale);
+
+        return {.groundSpeed = rates.groundSpeed,
+                .verticalSpeed = rates.verticalSpeed,
+                .acceleration = (speed - previousSpeed) * safeReciprocal(current.timestamp - previous.timestamp),
+                .distance = distance,
+                .headingRate = rates.headingRate};
+    }
+
+    DerivedChannels CompressedPath::interpolateChannels(const float timestamp, PlaybackCursor &cursor) {
+        if (sampleCount < 2)
+            return {};
+
+        const size_t index = std::min(findSample(timestamp, cursor), sampleCount - 2);
+        const FlightDataPoint startPoint = sample(index);
+        const FlightDataPoint endPoint = sample(index + 1);
+        const float span = endPoint.timestamp - startPoint.timestamp;
+        const float t = span > 0.f ? std::clamp((timestamp - startPoint.timestamp) / span, 0.f, 1.f) : 0.f;
+
+        const auto start = sampleChannels(index);
+        const auto end = sampleChannels(index + 1);
+        return {.groundSpeed = lerp(start.groundSpeed, end.groundSpeed, t),
+                .verticalSpeed = lerp(start.verticalSpeed, end.verticalSpeed, t),
+                .acceleration = lerp(start.acceleration, end.acceleration, t),
+                .distance = lerp(start.distance, end.distance, t),
+                .headingRate = lerp(start.headingRate, end.headingRate, t)};
+    }
+
+    std::vector<FlightDataPoint> CompressedPath::decode() const {
+        std::vector<FlightDataPoint> points(sampleCount);
+        for (size_t block = 0; block < blockTimestamps.size(); block++)
+            decodeBlock(block, std::span{points}.subspan(block * BlockSize));
+        return points;
+    }
+} // namespace dfv
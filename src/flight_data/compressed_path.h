@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief A compact, read-only encoding of a flight path, for keeping very long logs in memory.
+     * @details Every field is quantized to a fixed-point integer (1 ms, 1/1000 of a position unit, 1/10000 rad) and the
+     * path is split in blocks of BlockSize samples. The first sample of each block is stored uncompressed in a seek table,
+     * the others as the zigzag varint encoded differences from the sample before them, which take 1-3 bytes per field
+     * instead of 4 for typical logs.
+     *
+     * Blocks are decoded on demand into a small cache, so that playback lookups decode a block once and then only read
+     * from the cache until they move past it. Interpolating across a block boundary reads the next block's first sample
+     * from the seek table, never its encoded data.
+     * @note Lookups update the cache, so a path must not be used by multiple threads at once.
+     */
+    class CompressedPath {
+      public:
+        static constexpr size_t BlockSize = 256; //!< The number of samples encoded together
+
+        CompressedPath() = default;
+
+        /**
+         * @brief Encodes points sorted by timestamp.
+         * @param originLatitude The latitude the points are relative to, for deriving their channels in meters.
+         * @note Throws std::runtime_error if a value doesn't fit the fixed-point representation.
+         */
+        CompressedPath(std::span<const FlightDataPoint> points, double originLatitude);
+
+        size_t size() const;
+        bool empty() const;
+
+        /**
+         * @return The number of bytes used by the encoded path and its seek table, excluding the decoded-block cache.
+         */
+        size_t encodedSize() const;
+
+        float startTime() const;
+        float endTime() const;
+
+        /**
+         * @brief Interpolates the path at the given timestamp, starting the lookup from where the cursor was left.
+         * @note Timestamps outside the path are clamped to its first and last samples.
+         */
+        FlightDataPoint interpolate(float timestamp, PlaybackCursor &cursor);
+
+        /**
+         * @brief Interpolates the derived channels at the given timestamp, starting the lookup from the cursor.
+         * @details The channels are derived from the decoded samples around the timestamp the way FlightTrack derives
+         * them, and the distance from the distance stored for each block.
+         * @note Timestamps outside the path are clamped to its first and last samples.
+         */
+        DerivedChannels interpolateChannels(float timestamp, PlaybackCursor &cursor);
+
+        /**
+         * @brief Decodes every sample of the path.
+         */
+        std::vector<FlightDataPoint> decode() const;
+
+      private:
+        static constexpr size_t FieldCount = 7; //!< The number of fields of FlightDataPoint
+        static constexpr size_t CacheSize = 4; //!< The number of decoded blocks kept around
+
+        using QuantizedPoint = std::array<int32_t, FieldCount>;
+
+        struct CachedBlock {
+            size_t block{SIZE_MAX}; //!< The index of the decoded block, SIZE_MAX for an unused entry
+            uint64_t lastUse{0};
+            std::array<FlightDataPoint, BlockSize> points;
+        };
+
+        /**
+         * @brief Decodes a block into the given output, which must hold at least blockLength(block) points.
+         */
+        void decodeBlock(size_t block, std::span<FlightDataPoint> points) const;
+
+        /**
+         * @brief Returns the decoded samples of a block, decoding it into the least recently used cache entry if needed.
+         */
+        std::span<const FlightDataPoint> cachedBlock(size_t block);
+
+        size_t blockLength(size_t block) const;
+
+        /**
+         * @brief Returns the first sample of a block, read from the seek table.
+         */
+        FlightDataPoint keyPoint(size_t block) const;
+
+        /**
+         * @brief Finds the block containing the given timestamp, trying the cursor's block first.
+         */
+        size_t findBlock(float timestamp, const PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Finds the last sample at or before the given timestamp, the first sample if there is none.
+         * @details The cursor is updated to the found sample.
+         */
+        size_t findSample(float timestamp, PlaybackCursor &cursor);
+
+        /**
+         * @brief Returns the decoded sample at the given index, which may be the first of the next block.
+         */
+        FlightDataPoint sample(size_t index);
+
+        /**
+         * @brief Derives the channels of the sample at the given index from the samples before it.
+         */
+        DerivedChannels sampleChannels(size_t index);
+
+        size_t sampleCount{0};
+        float lastTimestamp{0.f};
+        std::vector<uint8_t> data; //!< The encoded differences of every sample except the first of each block
+
+        // The seek table, one entry per block
+        std::vector<float> blockTimestamps; //!< The timestamp of the first sample of each block, for searching
+        std::vector<QuantizedPoint> blockKeys; //!< The first sample of each block, the base of its differences
+        std::vector<uint32_t> blockOffsets; //!< The offset of each block's differences in data
+        std::vector<float> blockDistances; //!< The distance travelled up to the first sample of each block, in meters
+
+        UnitScale unitScale{};
+
+        std::array<CachedBlock, CacheSize> cache;
+        uint64_t useCounter{0};
+    };
+} // namespace dfv
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+namespace dfv::csv_tokenizer {
+    /**
+     * @brief Returns the next field starting at p, without surrounding quotes, and advances p to the delimiter that ends it.
+     */
+    inline std::string_view nextField(const char *&p, const char *end) {
+        if (p < end && *p == '"') {
+            // Quoted field, may contain delimiters and escaped quotes ("")
+            const char *start = ++p;
+            while (true) {
+                const auto *quote = static_cast<const char *>(std::memchr(p, '"', end - p));
+                if (!quote) {
+                    p = end;
+                    return {start, end};
+                }
+                if (quote + 1 < end && quote[1] == '"') {
+                    p = quote + 2;
+                    continue;
+                }
+                p = quote + 1;
+                std::string_view field{start, quote};
+                // Skip anything between the closing quote and the delimiter
+                while (p < end && *p != ',' && *p != '\n')
+                    ++p;
+                return field;
+            }
+        }
+
+        const char *start = p;
+        while (p < end && *p != ',' && *p != '\n')
+            ++p;
+        return {start, p};
+    }
+
+    /**
+     * @brief Returns a pointer to the start of the row following the one p is in, honoring quoted fields.
+     */
+    inline const char *skipRow(const char *p, const char *end) {
+        while (p < end) {
+            const auto *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            if (!newline)
+                return end;
+
+            const auto *quote = static_cast<const char *>(std::memchr(p, '"', newline - p));
+            if (!quote)
+                return newline + 1;
+
+            // Jump over the quoted section, which may contain newlines
+            const auto *closing = static_cast<const char *>(std::memchr(quote + 1, '"', end - quote - 1));
+            if (!closing)
+                return end;
+            p = closing + 1;
+        }
+        return end;
+    }
+
+    /**
+     * @brief Advances p past any empty lines.
+     */
+    inline void skipBlankLines(const char *&p, const char *end) {
+        while (p < end && (*p == '\n' || *p == '\r'))
+            ++p;
+    }
+
+    inline std::string_view trim(std::string_view field) {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t'))
+            field.remove_prefix(1);
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r'))
+            field.remove_suffix(1);
+        return field;
+    }
+
+    template<typename T>
+    bool parseNumber(std::string_view field, T &value) {
+        field = trim(field);
+        // from_chars does not accept a leading plus sign
+        if (!field.empty() && field.front() == '+')
+            field.remove_prefix(1);
+        if (field.empty())
+            return false;
+
+        const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return ec == std::errc{} && ptr == field.data() + field.size();
+    }
+} // namespace dfv::csv_tokenizer
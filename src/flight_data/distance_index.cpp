@@ -0,0 +1,69 @@
+#include "distance_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "interpolation.h"
+
+namespace dfv {
+    DistanceIndex::DistanceIndex(const FlightTrack &track)
+        : track(&track), timestamps(track.timestamps()), distances(track.distances()) {}
+
+    DistanceIndex::DistanceIndex(std::span<const FlightDataPoint> path, const double originLatitude)
+        : ownTimestamps(path.size()), ownDistances(path.size()) {
+        // The same 3D steps the track derives its distances from
+        const UnitScale scale = unitScaleAt(originLatitude);
+        float distance = 0.f;
+        for (size_t i = 0; i < path.size(); i++) {
+            if (i > 0) {
+                const float horizontal = horizontalDistance(path[i].x - path[i - 1].x, path[i].z - path[i - 1].z, scale);
+                const float dy = path[i].y - path[i - 1].y;
+                distance += std::sqrt(horizontal * horizontal + dy * dy);
+            }
+            ownTimestamps[i] = path[i].timestamp;
+            ownDistances[i] = distance;
+        }
+
+        timestamps = ownTimestamps;
+        distances = ownDistances;
+    }
+
+    bool DistanceIndex::empty() const {
+        return timestamps.empty();
+    }
+
+    float DistanceIndex::totalDistance() const {
+        return empty() ? 0.f : distances.back();
+    }
+
+    float DistanceIndex::timestampAt(const float distance) const {
+        // The first sample past the distance ends the step it is reached in, steps of zero length are never selected
+        const auto next = std::upper_bound(distances.begin(), distances.end(), distance);
+        if (next == distances.begin())
+            return timestamps.front();
+        if (next == distances.end())
+            return timestamps.back();
+
+        const auto segment = static_cast<size_t>(next - distances.begin()) - 1;
+        const float t = (distance - distances[segment]) / (distances[segment + 1] - distances[segment]);
+        return lerp(timestamps[segment], timestamps[segment + 1], t);
+    }
+
+    float DistanceIndex::distanceAt(const float timestamp) const {
+        if (timestamp <= timestamps.front())
+            return distances.front();
+        if (timestamp >= timestamps.back())
+            return distances.back();
+
+        // Within the path, the segment starts at or before the timestamp and ends after it, so it has a duration
+        size_t segment;
+        if (track) {
+            segment = track->findSegment(timestamp);
+        } else {
+            const auto next = std::upper_bound(timestamps.begin(), timestamps.end(), timestamp);
+            segment = static_cast<size_t>(next - timestamps.begin()) - 1;
+        }
+        const float t = (timestamp - timestamps[segment]) / (timestamps[segment + 1] - timestamps[segment]);
+        return lerp(distances[segment], distances[segment + 1], t);
+    }
+} // namespace dfv
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "flight_data.h"
+#include "flight_track.h"
+
+namespace dfv {
+    /**
+     * @brief The cumulative distance travelled along a flight path, for seeking by distance instead of time.
+     * @details Distances are those of the track, the sums of the 3D steps between consecutive samples in meters. They
+     * never decrease, so converting between distance and time is a lookup followed by a linear interpolation within a
+     * step.
+     */
+    class DistanceIndex {
+      public:
+        DistanceIndex() = default;
+
+        /**
+         * @brief Indexes the timestamps and distances of the track, which must outlive the index.
+         */
+        explicit DistanceIndex(const FlightTrack &track);
+
+        /**
+         * @brief Indexes a path sorted by timestamp, for sources that don't keep a track of their own.
+         * @details Only the timestamps and distances of the path are kept.
+         * @param originLatitude The latitude the path is relative to, see FlightTrack.
+         */
+        DistanceIndex(std::span<const FlightDataPoint> path, double originLatitude);
+
+        // Disallow copying and moving, the index may point to its own columns
+        DistanceIndex(const DistanceIndex &) = delete;
+        DistanceIndex &operator=(const DistanceIndex &) = delete;
+
+        bool empty() const;
+
+        /**
+         * @return The length of the whole path in meters.
+         */
+        float totalDistance() const;
+
+        /**
+         * @brief Returns the timestamp at which the given distance along the path is reached.
+         * @note Distances outside the path are clamped. Must not be called on an empty index.
+         */
+        float timestampAt(float distance) const;
+
+        /**
+         * @brief Returns the distance travelled along the path at the given timestamp.
+         * @note Timestamps outside the path are clamped. Must not be called on an empty index.
+         */
+        float distanceAt(float timestamp) const;
+
+      private:
+        const FlightTrack *track = nullptr; //!< Used to find segments with its index, null when built from a path
+        std::span<const float> timestamps;
+        std::span<const float> distances;
+
+        // Computed from the path when the source has no track
+        std::vector<float> ownTimestamps;
+        std::vector<float> ownDistances;
+    };
+} // namespace dfv
@@ -0,0 +1,385 @@
+#include "dji_csv_parser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <glm/glm.hpp>
+
+#include <utils/mapped_file.h>
+
+#include "csv_tokenizer.h"
+
+namespace dfv {
+    namespace {
+        using namespace csv_tokenizer;
+
+        constexpr double FeetToMeter = 0.3048;
+        constexpr size_t MinChunkSize = 1 << 20; //!< Files are not split in chunks smaller than this, in bytes
+        constexpr size_t FirstBlockSize = 64 << 10; //!< The size of the first block parsed by progressive parsing, in bytes
+
+        // Must match the order of DjiCsvParser::Slot
+        constexpr std::array<std::string_view, 7> ColumnNames = {
+                DjiCsvParser::LatitudeColumn,
+                DjiCsvParser::LongitudeColumn,
+                "OSD.altitude [ft]",
+                DjiCsvParser::TimeColumn,
+                "OSD.yaw",
+                "OSD.pitch",
+                "OSD.roll",
+        };
+
+        /**
+         * @brief Splits data into count contiguous ranges of roughly equal size, each ending at a row boundary.
+         * @note Rows containing quoted newlines may be split incorrectly if a boundary falls inside them.
+         */
+        std::vector<std::span<const char>> splitRows(std::span<const char> data, const size_t count) {
+            std::vector<std::span<const char>> ranges;
+            ranges.reserve(count);
+
+            const char *begin = data.data();
+            const char *end = data.data() + data.size();
+            for (size_t i = 1; i <= count; i++) {
+                const char *split = i == count ? end : data.data() + data.size() / count * i;
+                if (split <= begin) {
+                    split = begin;
+                } else if (split != end) {
+                    // Move the split point past the end of the row it falls in
+                    const auto *newline = static_cast<const char *>(std::memchr(split - 1, '\n', end - split + 1));
+                    split = newline ? newline + 1 : end;
+                }
+
+                ranges.emplace_back(begin, split);
+                begin = split;
+            }
+
+            return ranges;
+        }
+
+        /**
+         * @brief Parses rows starting at cursor until the first valid one, which becomes the origin of the flight.
+         * @note Throws std::runtime_error if there are no valid rows.
+         */
+        void parseOrigin(const DjiCsvParser &parser, const char *&cursor, const char *end, ParsedFlight &flight) {
+            DjiCsvParser::Row row{};
+            bool foundOrigin = false;
+            while (!foundOrigin) {
+                skipBlankLines(cursor, end);
+                if (cursor == end)
+                    throw std::runtime_error("Flight data contains no valid rows");
+
+                foundOrigin = parser.parseRow(cursor, end, row);
+                if (!foundOrigin)
+                    flight.skippedRows++;
+            }
+
+            flight.initialPosition = row.coords;
+            flight.points.push_back(DjiCsvParser::toPoint(row, flight.initialPosition));
+            flight.summary.extend(row.coords);
+        }
+
+        /**
+         * @brief The result of parsing a single range of rows.
+         */
+        struct Chunk {
+            std::vector<FlightDataPoint> points;
+            FlightSummary summary;
+            size_t skippedRows;
+        };
+
+        /**
+         * @brief Splits the range in chunkCount row-aligned chunks and parses them concurrently.
+         * @return The parsed chunks, in file order.
+         */
+        std::vector<Chunk> parseChunks(const DjiCsvParser &parser, std::span<const char> range, const Coordinate &origin,
+                                       const size_t chunkCount) {
+            std::vector<std::future<Chunk>> chunkFutures;
+            chunkFutures.reserve(chunkCount);
+            for (const auto chunkRange : splitRows(range, chunkCount)) {
+                chunkFutures.push_back(std::async(std::launch::async, [&parser, chunkRange, origin] {
+                    Chunk chunk{};
+                    chunk.points.reserve(chunkRange.size() / 256);
+                    chunk.skippedRows = parser.parseRange(chunkRange, origin, chunk.points, chunk.summary);
+                    return chunk;
+                }));
+            }
+
+            std::vector<Chunk> chunks;
+            chunks.reserve(chunkCount);
+            for (auto &future : chunkFutures)
+                chunks.push_back(future.get());
+
+            return chunks;
+        }
+
+        /**
+         * @brief Reduces the chunk summaries into the flight and appends their points in file order.
+         */
+        void appendChunks(ParsedFlight &flight, std::vector<Chunk> &chunks) {
+            size_t pointCount = flight.points.size();
+            for (const auto &chunk : chunks) {
+                flight.summary.merge(chunk.summary);
+                flight.skippedRows += chunk.skippedRows;
+                pointCount += chunk.points.size();
+            }
+
+            flight.points.reserve(pointCount);
+            for (auto &chunk : chunks) {
+                flight.points.insert(flight.points.end(), chunk.points.begin(), chunk.points.end());
+                chunk.points = {};
+            }
+        }
+
+        bool byTimestamp(const FlightDataPoint &a, const FlightDataPoint &b) {
+            return a.timestamp < b.timestamp;
+        }
+    } // namespace
+
+    void FlightSummary::extend(const Coordinate &coords) {
+        boundingBox.llLat = std::min(boundingBox.llLat, coords.lat);
+        boundingBox.llLon = std::min(boundingBox.llLon, coords.lon);
+        boundingBox.urLat = std::max(boundingBox.urLat, coords.lat);
+        boundingBox.urLon = std::max(boundingBox.urLon, coords.lon);
+        minimumAltitude = std::min(minimumAltitude, static_cast<float>(coords.alt));
+        maximumAltitude = std::max(maximumAltitude, static_cast<float>(coords.alt));
+    }
+
+    void FlightSummary::merge(const FlightSummary &other) {
+        boundingBox.llLat = std::min(boundingBox.llLat, other.boundingBox.llLat);
+        boundingBox.llLon = std::min(boundingBox.llLon, other.boundingBox.llLon);
+        boundingBox.urLat = std::max(boundingBox.urLat, other.boundingBox.urLat);
+        boundingBox.urLon = std::max(boundingBox.urLon, other.boundingBox.urLon);
+        minimumAltitude = std::min(minimumAltitude, other.minimumAltitude);
+        maximumAltitude = std::max(maximumAltitude, other.maximumAltitude);
+    }
+
+    DjiCsvParser::DjiCsvParser(std::string_view header) {
+        std::array<int, SlotCount> slotColumns;
+        slotColumns.fill(-1);
+
+        const char *p = header.data();
+        const char *end = header.data() + header.size();
+        for (int column = 0; p <= end; column++) {
+            const auto name = trim(nextField(p, end));
+
+            const auto it = std::find(ColumnNames.begin(), ColumnNames.end(), name);
+            if (it != ColumnNames.end() && slotColumns[it - ColumnNames.begin()] < 0)
+                slotColumns[it - ColumnNames.begin()] = column;
+
+            if (p >= end || *p == '\n')
+                break;
+            p++; // Skip the delimiter
+        }
+
+        for (size_t slot = 0; slot < SlotCount; slot++) {
+            if (slotColumns[slot] < 0)
+                throw std::runtime_error("Flight data is missing the required column " + std::string{ColumnNames[slot]});
+        }
+
+        columnSlots.assign(*std::max_element(slotColumns.begin(), slotColumns.end()) + 1, NoSlot);
+        for (size_t slot = 0; slot < SlotCount; slot++)
+            columnSlots[slotColumns[slot]] = static_cast<int8_t>(slot);
+    }
+
+    std::pair<std::string_view, std::span<const char>> DjiCsvParser::splitHeader(std::span<const char> data) {
+        const char *p = data.data();
+        const char *end = data.data() + data.size();
+
+        constexpr std::string_view Bom = "\xEF\xBB\xBF";
+        if (std::string_view{p, end}.starts_with(Bom))
+            p += Bom.size();
+
+        // Some exporters prepend a line specifying the delimiter for spreadsheet applications
+        if (std::string_view{p, end}.starts_with("sep="))
+            p = skipRow(p, end);
+
+        const char *bodyBegin = skipRow(p, end);
+        const char *headerEnd = bodyBegin;
+        while (headerEnd > p && (headerEnd[-1] == '\n' || headerEnd[-1] == '\r'))
+            headerEnd--;
+
+        return {std::string_view{p, headerEnd}, std::span<const char>{bodyBegin, end}};
+    }
+
+    ParsedFlight DjiCsvParser::parseFile(const std::filesystem::path &path, unsigned int threadCount) {
+        const MappedFile file{path};
+        const auto [header, body] = splitHeader(file.data());
+        const DjiCsvParser parser{header};
+
+        ParsedFlight flight{};
+        const char *cursor = body.data();
+        const char *end = body.data() + body.size();
+
+        // The first valid row defines the origin all the other points are relative to
+        parseOrigin(parser, cursor, end, flight);
+
+        const std::span<const char> remaining{cursor, end};
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        // Don't split small files, spawning the workers would cost more than parsing
+        const size_t chunkCount = std::clamp<size_t>(remaining.size() / MinChunkSize, 1, threadCount);
+
+        if (chunkCount == 1) {
+            // Assume an average row length of a few hundred bytes to avoid most reallocations
+            flight.points.reserve(body.size() / 256);
+            flight.skippedRows += parser.parseRange(remaining, flight.initialPosition, flight.points, flight.summary);
+            return flight;
+        }
+
+        auto chunks = parseChunks(parser, remaining, flight.initialPosition, chunkCount);
+        appendChunks(flight, chunks);
+
+        // Logs are written in time order, only sort if the file was not
+        if (!std::is_sorted(flight.points.begin(), flight.points.end(), byTimestamp))
+            std::stable_sort(flight.points.begin(), flight.points.end(), byTimestamp);
+
+        return flight;
+    }
+
+    ParsedFlight DjiCsvParser::parseFileProgressive(const std::filesystem::path &path, unsigned int threadCount,
+                                                    const ProgressCallback &onProgress) {
+        const MappedFile file{path};
+        const auto [header, body] = splitHeader(file.data());
+        const DjiCsvParser parser{header};
+
+        ParsedFlight flight{};
+        const char *cursor = body.data();
+        const char *end = body.data() + body.size();
+
+        parseOrigin(parser, cursor, end, flight);
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t maxBlockSize = MinChunkSize * threadCount;
+
+        // Start with a small block so that the first rows are available almost immediately
+        size_t blockSize = FirstBlockSize;
+        bool firstBlock = true;
+        while (cursor != end) {
+            const char *blockEnd = cursor + std::min<size_t>(blockSize, end - cursor);
+            if (blockEnd != end) {
+                const auto *newline = static_cast<const char *>(std::memchr(blockEnd - 1, '\n', end - blockEnd + 1));
+                blockEnd = newline ? newline + 1 : end;
+            }
+            const std::span<const char> block{cursor, blockEnd};
+            cursor = blockEnd;
+            blockSize = std::min(blockSize * 2, maxBlockSize);
+
+            const size_t previousCount = flight.points.size();
+            const size_t chunkCount = std::clamp<size_t>(block.size() / MinChunkSize, 1, threadCount);
+            if (chunkCount == 1) {
+                flight.skippedRows += parser.parseRange(block, flight.initialPosition, flight.points, flight.summary);
+            } else {
+                auto chunks = parseChunks(parser, block, flight.initialPosition, chunkCount);
+                appendChunks(flight, chunks);
+            }
+
+            // Points already reported can't move anymore, so the block is sorted on its own and rows that go back in
+            // time compared to the previous blocks are dropped
+            const auto blockBegin = flight.points.begin() + static_cast<std::ptrdiff_t>(previousCount);
+            if (!std::is_sorted(blockBegin, flight.points.end(), byTimestamp))
+                std::stable_sort(blockBegin, flight.points.end(), byTimestamp);
+            const auto firstInOrder = std::lower_bound(blockBegin, flight.points.end(), *std::prev(blockBegin), byTimestamp);
+            flight.skippedRows += static_cast<size_t>(firstInOrder - blockBegin);
+            flight.points.erase(blockBegin, firstInOrder);
+
+            // The average length of the rows parsed so far estimates how many the rest of the body holds, without
+            // reading ahead of the blocks
+            const size_t parsedRows = flight.points.size() + flight.skippedRows;
+            const size_t rowLength = std::max<size_t>(static_cast<size_t>(cursor - body.data()) / parsedRows, 1);
+            const size_t estimatedRows = flight.points.size() + static_cast<size_t>(end - cursor) / rowLength;
+            // Reserving once is enough, the points grow geometrically past an estimate that falls short
+            if (firstBlock)
+                flight.points.reserve(estimatedRows);
+            firstBlock = false;
+
+            if (!onProgress(flight, estimatedRows))
+                break;
+        }
+
+        return flight;
+    }
+
+    bool DjiCsvParser::parseRow(const char *&cursor, const char *end, Row &row) const {
+        std::array<std::string_view, SlotCount> fields{};
+
+        const char *p = cursor;
+        size_t column = 0;
+        // Tokenize only up to the last required column
+        for (; column < columnSlots.size(); column++) {
+            const auto field = nextField(p, end);
+            if (columnSlots[column] != NoSlot)
+                fields[columnSlots[column]] = field;
+
+            if (p >= end || *p == '\n')
+                break;
+            p++; // Skip the delimiter
+        }
+
+        // The delimiter ending the last required field may already be the end of the row
+        if (p < end && *p == '\n')
+            cursor = p + 1;
+        else
+            cursor = skipRow(p, end);
+
+        if (column < columnSlots.size() - 1)
+            return false;
+
+        float yawDeg, pitchDeg, rollDeg, altitudeFt;
+        const bool valid = parseNumber(fields[Latitude], row.coords.lat) &&
+                           parseNumber(fields[Longitude], row.coords.lon) &&
+                           parseNumber(fields[Altitude], altitudeFt) &&
+                           parseNumber(fields[FlyTime], row.flyTime) &&
+                           parseNumber(fields[Yaw], yawDeg) &&
+                           parseNumber(fields[Pitch], pitchDeg) &&
+                           parseNumber(fields[Roll], rollDeg);
+        if (!valid)
+            return false;
+
+        row.coords.alt = altitudeFt * FeetToMeter;
+        row.yaw = glm::radians(yawDeg);
+        row.pitch = glm::radians(pitchDeg);
+        row.roll = glm::radians(rollDeg);
+        return true;
+    }
+
+    size_t DjiCsvParser::parseRange(std::span<const char> range, const Coordinate &origin,
+                                    std::vector<FlightDataPoint> &points, FlightSummary &summary) const {
+        size_t skippedRows = 0;
+        const char *cursor = range.data();
+        const char *end = range.data() + range.size();
+
+        Row row{};
+        while (true) {
+            skipBlankLines(cursor, end);
+            if (cursor == end)
+                break;
+
+            if (!parseRow(cursor, end, row)) {
+                skippedRows++;
+                continue;
+            }
+
+            summary.extend(row.coords);
+            points.push_back(toPoint(row, origin));
+        }
+
+        return skippedRows;
+    }
+
+    FlightDataPoint DjiCsvParser::toPoint(const Row &row, const Coordinate &origin) {
+        const Coordinate relativeCoords = calculateRelativePosition(row.coords, origin);
+
+        return {.timestamp = row.flyTime,
+                .x = static_cast<float>(relativeCoords.lon),
+                .y = static_cast<float>(relativeCoords.alt),
+                .z = static_cast<float>(relativeCoords.lat),
+                .yaw = row.yaw,
+                .pitch = row.pitch,
+                .roll = row.roll};
+    }
+} // namespace dfv
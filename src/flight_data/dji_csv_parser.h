@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief Aggregate properties of a flight, accumulated while its samples are parsed.
+     * @details A default-constructed summary is empty and acts as the identity for merge().
+     */
+    struct FlightSummary {
+        FlightBoundingBox boundingBox{.llLat = std::numeric_limits<double>::infinity(),
+                                      .llLon = std::numeric_limits<double>::infinity(),
+                                      .urLat = -std::numeric_limits<double>::infinity(),
+                                      .urLon = -std::numeric_limits<double>::infinity()};
+        float minimumAltitude{std::numeric_limits<float>::infinity()}; //!< Minimum altitude in meters
+        float maximumAltitude{-std::numeric_limits<float>::infinity()}; //!< Maximum altitude in meters
+
+        /**
+         * @brief Extends the summary to include the given coordinate.
+         */
+        void extend(const Coordinate &coords);
+
+        /**
+         * @brief Extends the summary to include everything covered by another summary.
+         */
+        void merge(const FlightSummary &other);
+    };
+
+    /**
+     * @brief The result of parsing a flight log.
+     */
+    struct ParsedFlight {
+        std::vector<FlightDataPoint> points; //!< Samples relative to the initial position
+        Coordinate initialPosition; //!< The absolute position of the first valid sample
+        FlightSummary summary;
+        size_t skippedRows; //!< Rows that were malformed or missing one of the required values
+    };
+
+    /**
+     * @brief A parser for DJI flight logs in CSV format working directly on the raw file bytes.
+     * @details Column indices are resolved once from the header, rows are then tokenized in place and numbers are
+     * parsed with std::from_chars, without allocating per row.
+     */
+    class DjiCsvParser {
+      public:
+        static constexpr std::string_view TimeColumn = "OSD.flyTime [s]"; //!< The column holding the timestamp of each row
+        static constexpr std::string_view LatitudeColumn = "OSD.latitude";
+        static constexpr std::string_view LongitudeColumn = "OSD.longitude";
+
+        /**
+         * @brief The values of a single row, converted to meters and radians.
+         */
+        struct Row {
+            float flyTime; //!< Timestamp in seconds
+            Coordinate coords; //!< Absolute position, altitude in meters
+            float yaw;
+            float pitch;
+            float roll;
+        };
+
+        /**
+         * @brief Constructs a parser for the given CSV header line.
+         * @note Throws std::runtime_error if any of the required columns is missing.
+         */
+        explicit DjiCsvParser(std::string_view header);
+
+        /**
+         * @brief Splits raw CSV data into its header line and the body containing the rows.
+         * @details Skips a leading UTF-8 BOM and the "sep=" line some exporters prepend.
+         * @return The header line and the span of bytes following it.
+         */
+        static std::pair<std::string_view, std::span<const char>> splitHeader(std::span<const char> data);
+
+        /**
+         * @brief Parses the whole flight log at the given path.
+         * @param threadCount The number of workers to split the file across, 0 to use all hardware threads.
+         * @details Large files are split in newline-aligned byte ranges that are parsed concurrently, the per-range
+         * results are then reduced into a single summary and merged in timestamp order.
+         * @note Throws std::runtime_error if the file cannot be read or contains no valid rows.
+         */
+        static ParsedFlight parseFile(const std::filesystem::path &path, unsigned int threadCount = 1);
+
+        /**
+         * @brief Called by parseFileProgressive after each block of rows has been parsed.
+         * @param flight The flight parsed so far, whose points only ever grow between calls.
+         * @param estimatedRows An estimate of the number of points the whole file produces, from the average length of
+         * the rows parsed so far. It is never less than the points parsed so far, but may be exceeded by the next blocks.
+         * @return False to stop parsing early.
+         */
+        using ProgressCallback = std::function<bool(const ParsedFlight &flight, size_t estimatedRows)>;
+
+        /**
+         * @brief Parses the whole flight log at the given path in file order, reporting the points parsed so far after
+         * each block of rows.
+         * @param threadCount The number of workers each block is split across, 0 to use all hardware threads.
+         * @details Blocks start small so that the first rows are reported quickly, then grow up to one chunk per worker.
+         * Reported points never move: rows going back in time compared to the previous blocks are skipped.
+         * @note Throws std::runtime_error if the file cannot be read or contains no valid rows.
+         */
+        static ParsedFlight parseFileProgressive(const std::filesystem::path &path, unsigned int threadCount,
+                                                 const ProgressCallback &onProgress);
+
+        /**
+         * @brief Parses the row starting at cursor and advances cursor to the start of the next row.
+         * @return True if the row held valid values for all the required columns, false otherwise.
+         */
+        bool parseRow(const char *&cursor, const char *end, Row &row) const;
+
+        /**
+         * @brief Parses all the rows in the given range, converting them to points relative to origin.
+         * @param points The vector to append the parsed points to.
+         * @param summary The summary to extend with the parsed points.
+         * @return The number of rows that were skipped.
+         */
+        size_t parseRange(std::span<const char> range, const Coordinate &origin,
+                          std::vector<FlightDataPoint> &points, FlightSummary &summary) const;
+
+        /**
+         * @brief Converts a parsed row to a flight data point relative to the given origin.
+         */
+        static FlightDataPoint toPoint(const Row &row, const Coordinate &origin);
+
+      private:
+        /**
+         * @brief The columns required to build a FlightDataPoint, used as indices into the slot tables.
+         */
+        enum Slot : int8_t {
+            Latitude,
+            Longitude,
+            Altitude,
+            FlyTime,
+            Yaw,
+            Pitch,
+            Roll,
+            SlotCount,
+            NoSlot = -1,
+        };
+
+        std::vector<int8_t> columnSlots; //!< Maps each column index up to the last required one to its slot
+    };
+} // namespace dfv
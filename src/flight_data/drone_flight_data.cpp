@@ -3,17 +3,55 @@
 #include <glm/glm.hpp>
 
 #include <csv.hpp>
+#include <thread>
 #include <utility>
 #include <utils/time_types.h>
-#define M_PI 3.14159265358979323846f
+
+#include "dji_csv_parser.h"
+#include "flight_cache.h"
 
 namespace dfv {
-    DroneFlightData::DroneFlightData(std::filesystem::path path)
-        : path(std::move(path)), boundingBox() {}
+    // Indexing runs while the flight plays, so it leaves most of the hardware threads to rendering
+    static constexpr unsigned int MaxTelemetryThreads = 4;
+
+    /**
+     * @brief Prints the time taken to read the flight data and the resulting throughput.
+     */
+    static void printReadStats(const size_t rowCount, const nanoseconds duration) {
+        const auto seconds = std::chrono::duration<double>(duration).count();
+        const auto rowsPerSecond = seconds > 0 ? static_cast<uint64_t>(static_cast<double>(rowCount) / seconds) : 0;
+        std::cout << "Flight data read in " << duration_cast<milliseconds>(duration).count() << "ms ("
+                  << rowCount << " rows, " << rowsPerSecond << " rows/s)" << std::endl;
+    }
+
+    DroneFlightData::DroneFlightData(std::filesystem::path path, DroneFlightDataOptions options)
+        : path(std::move(path)), options(options), boundingBox() {}
+
+    DroneFlightData::~DroneFlightData() {
+        cancelLoad = true;
+        if (progressiveLoad.valid())
+            progressiveLoad.wait();
+        if (telemetryIndex.valid())
+            telemetryIndex.wait();
+    }
 
     bool DroneFlightData::load() {
         try {
-            flightDataPoints = loadFlightData(path.string());
+            // A valid cache loads faster than any progressive parse could show the first rows
+            if (options.progressive && !options.compressPath && !options.legacyReader &&
+                !(options.useCache && FlightCache{path}.loadHeader())) {
+                startProgressiveLoad();
+                return true;
+            }
+
+            flightDataPoints = options.legacyReader ? loadFlightDataLegacy(path.string()) : loadFlightData(path);
+            scanForAnomalies();
+            if (options.compressPath) {
+                buildPathHierarchy();
+                compressFlightData();
+            } else {
+                track = FlightTrack{flightDataPoints, getInitialPosition().lat};
+            }
         } catch (const std::exception &e) {
             std::cerr << "Error while loading flight data: " << e.what() << std::endl;
             return false;
@@ -21,79 +59,327 @@ namespace dfv {
         return true;
     }
 
+    void DroneFlightData::update() {
+        // Readers only hold a track during a single call, so every track but the active one can go
+        std::scoped_lock lock{grownTracksMutex};
+        if (grownTracks.empty())
+            return;
+
+        while (grownTracks.size() > 1)
+            grownTracks.pop_front();
+        if (!track.empty())
+            track = FlightTrack{};
+    }
+
+    bool DroneFlightData::isLoadComplete() {
+        return loadComplete.load(std::memory_order_acquire);
+    }
+
+    seconds_f DroneFlightData::getValidUntil() {
+        return getEndTime();
+    }
+
     Coordinate DroneFlightData::getInitialPosition() {
         return initialPosition ? initialPosition.value() : Coordinate{};
     }
 
-    std::vector<FlightDataPoint> &DroneFlightData::getPath() {
+    const std::vector<FlightDataPoint> &DroneFlightData::getPath() {
+        if (options.compressPath && !pathHierarchy.empty())
+            return pathHierarchy.levels().front().points;
+        return flightDataPoints;
+    }
+
+    std::vector<FlightDataPoint> DroneFlightData::decodePath() {
+        if (options.compressPath)
+            return compressedPath.decode();
         return flightDataPoints;
     }
 
+    std::span<const FlightDataPoint> DroneFlightData::getSimplifiedPath(const float maxError) {
+        // Like the path, the hierarchy is only available once the load is complete. It is only needed for drawing, so it
+        // is built on first use, unless compressing the path already required it
+        if (!isLoadComplete())
+            return {};
+
+        std::call_once(pathHierarchyBuilt, [this] {
+            if (pathHierarchy.empty())
+                buildPathHierarchy();
+        });
+        if (pathHierarchy.empty())
+            return {};
+
+        return pathHierarchy.selectLevel(maxError).points;
+    }
+
+    void DroneFlightData::buildPathHierarchy() {
+        const auto startTime = clock::now();
+        pathHierarchy = PathHierarchy{flightDataPoints, 0.5f, options.parserThreads};
+
+        const auto &levels = pathHierarchy.levels();
+        if (!levels.empty() && !options.quiet) {
+            std::cout << "Path simplification took " << duration_cast<milliseconds>(clock::now() - startTime).count()
+                      << "ms (" << levels.size() << " levels, " << levels.front().points.size() << " to "
+                      << levels.back().points.size() << " points)" << std::endl;
+        }
+    }
+
+    void DroneFlightData::scanForAnomalies() {
+        if (!options.scanAnomalies)
+            return;
+
+        const auto startTime = clock::now();
+        anomalies = scanAnomalies(flightDataPoints, getInitialPosition().lat, {}, options.parserThreads);
+
+        if (!options.quiet) {
+            std::cout << "Anomaly scan took " << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms ("
+                      << anomalies.size() << " anomalies)" << std::endl;
+        }
+    }
+
+    void DroneFlightData::compressFlightData() {
+        const auto startTime = clock::now();
+        compressedPath = CompressedPath{flightDataPoints, getInitialPosition().lat};
+
+        if (!options.quiet) {
+            std::cout << "Path compression took " << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms ("
+                      << flightDataPoints.size() * sizeof(FlightDataPoint) << " to " << compressedPath.encodedSize()
+                      << " bytes)" << std::endl;
+        }
+
+        // The finest level of the hierarchy stands in for the path, the full points are no longer needed
+        flightDataPoints = {};
+    }
+
+    void DroneFlightData::startTelemetryIndex() {
+        telemetryIndex = std::async(std::launch::async, [this] {
+            const auto startTime = clock::now();
+            const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            const unsigned int threads = std::min(options.parserThreads != 0 ? options.parserThreads : hardwareThreads,
+                                                  MaxTelemetryThreads);
+            try {
+                telemetry.emplace(path, DjiCsvParser::TimeColumn, threads, &cancelLoad);
+            } catch (const std::exception &e) {
+                // The flight can be shown without it, and a cancelled index is only stopped by the destructor
+                if (!cancelLoad)
+                    std::cerr << "Telemetry unavailable: " << e.what() << std::endl;
+                telemetry.reset();
+                return;
+            }
+
+            if (!options.quiet) {
+                std::cout << "Telemetry indexed in " << duration_cast<milliseconds>(clock::now() - startTime).count()
+                          << "ms (" << telemetry->columnNames().size() << " columns, " << telemetry->rowCount()
+                          << " rows, " << telemetry->blockCount() << " blocks)" << std::endl;
+            }
+            telemetryReady.store(true, std::memory_order_release);
+        });
+    }
+
     FlightDataPoint DroneFlightData::getPoint(seconds_f timestamp) {
-        // upper_bound returns the first element that is greater than the timestamp, aka the next point
-        // if the timestamp is 0 or less, this will return the first point
-        auto nextPointIt = std::upper_bound(flightDataPoints.begin(), flightDataPoints.end(), timestamp,
-                                            [](const seconds_f &timestamp, const FlightDataPoint &point) {
-                                                return timestamp.count() < point.timestamp;
-                                            });
-
-        // Get the current point by going back one element
-        auto pointIt = nextPointIt != flightDataPoints.begin() ? nextPointIt - 1 : nextPointIt;
-
-        if (nextPointIt == flightDataPoints.end())
-            return *pointIt;
-
-        // Interpolate between the current point and the next one
-        float lerpTime = (timestamp.count() - pointIt->timestamp) / (nextPointIt->timestamp - pointIt->timestamp);
-
-        auto lerp = [&](float start, float end) {
-            return start + (end - start) * lerpTime;
-        };
-
-        auto lerpAngle = [&](float start, float end) {
-            float diff = end - start;
-            // Lerp the angle in the shortest direction
-            if (diff > M_PI)
-                diff -= 2 * M_PI;
-            else if (diff < -M_PI)
-                diff += 2 * M_PI;
-
-            return start + diff * lerpTime;
-        };
-
-        return {.timestamp = timestamp.count(),
-                .x = lerp(pointIt->x, nextPointIt->x),
-                .y = lerp(pointIt->y, nextPointIt->y),
-                .z = lerp(pointIt->z, nextPointIt->z),
-                .yaw = lerpAngle(pointIt->yaw, nextPointIt->yaw),
-                .pitch = lerpAngle(pointIt->pitch, nextPointIt->pitch),
-                .roll = lerpAngle(pointIt->roll, nextPointIt->roll)};
+        if (options.compressPath) {
+            PlaybackCursor cursor{};
+            return compressedPath.interpolate(timestamp.count(), cursor);
+        }
+        return currentTrack().interpolate(timestamp.count());
+    }
+
+    FlightDataPoint DroneFlightData::getPoint(seconds_f timestamp, PlaybackCursor &cursor) {
+        if (options.compressPath)
+            return compressedPath.interpolate(timestamp.count(), cursor);
+        return currentTrack().interpolate(timestamp.count(), cursor);
+    }
+
+    void DroneFlightData::getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) {
+        if (options.compressPath)
+            FlightData::getPoints(timestamps, points);
+        else
+            currentTrack().interpolate(timestamps, points);
+    }
+
+    FlightPose DroneFlightData::getPose(seconds_f timestamp, PlaybackCursor &cursor) {
+        if (options.compressPath)
+            return FlightData::getPose(timestamp, cursor);
+        return currentTrack().interpolatePose(timestamp.count(), cursor);
+    }
+
+    DerivedChannels DroneFlightData::getChannels(seconds_f timestamp, PlaybackCursor &cursor) {
+        if (options.compressPath)
+            return compressedPath.interpolateChannels(timestamp.count(), cursor);
+        return currentTrack().interpolateChannels(timestamp.count(), cursor);
+    }
+
+    TelemetryStore *DroneFlightData::getTelemetry() {
+        if (options.headless || !isLoadComplete())
+            return nullptr;
+
+        // The index reads the whole CSV again, so only flights whose telemetry is asked for pay for it
+        std::call_once(telemetryIndexStarted, [this] { startTelemetryIndex(); });
+
+        // Only written by the indexing task, which publishes it once done
+        if (!telemetryReady.load(std::memory_order_acquire))
+            return nullptr;
+        return &*telemetry;
+    }
+
+    const FlightTrack *DroneFlightData::getTrack() {
+        if (options.compressPath || !isLoadComplete())
+            return nullptr;
+        return &currentTrack();
+    }
+
+    std::span<const FlightAnomaly> DroneFlightData::getAnomalies() {
+        if (!isLoadComplete())
+            return {};
+        return anomalies;
     }
 
     float DroneFlightData::getMaximumAltitude() {
+        std::scoped_lock lock{summaryMutex};
         return maximumAltitude;
     }
     float DroneFlightData::getMinimumAltitude() {
+        std::scoped_lock lock{summaryMutex};
         return minimumAltitude;
     }
 
+    // The track is used rather than the points, which are only available once a progressive load is complete
+
     seconds_f DroneFlightData::getDuration() {
-        return seconds_f{flightDataPoints.back().timestamp};
+        return getEndTime();
     }
 
     seconds_f DroneFlightData::getStartTime() {
-        return seconds_f{flightDataPoints.front().timestamp};
+        return seconds_f{options.compressPath ? compressedPath.startTime() : currentTrack().timestamps().front()};
     }
 
     seconds_f DroneFlightData::getEndTime() {
-        return seconds_f{flightDataPoints.back().timestamp};
+        return seconds_f{options.compressPath ? compressedPath.endTime() : currentTrack().timestamps().back()};
     }
 
     FlightBoundingBox DroneFlightData::getBoundingBox() {
+        std::scoped_lock lock{summaryMutex};
         return boundingBox;
     }
 
-    std::vector<FlightDataPoint> DroneFlightData::loadFlightData(const std::string &csvPath) {
+    void DroneFlightData::startProgressiveLoad() {
+        loadComplete = false;
+
+        std::promise<void> firstBlockPromise;
+        auto firstBlockFuture = firstBlockPromise.get_future();
+
+        progressiveLoad = std::async(std::launch::async, [this, firstBlockPromise = std::move(firstBlockPromise)]() mutable {
+            const auto startTime = clock::now();
+            bool started = false;
+
+            const auto onProgress = [&](const ParsedFlight &parsed, const size_t estimatedRows) {
+                if (!started) {
+                    // Nothing reads the track before the first block is signalled, so it can still be replaced
+                    initialPosition = parsed.initialPosition;
+                    track = FlightTrack{estimatedRows, parsed.initialPosition.lat};
+                }
+
+                FlightTrack &current = lastTrack();
+                current.append(std::span{parsed.points}.subspan(current.size()));
+                if (current.size() < parsed.points.size()) {
+                    // Out of capacity, move to a track at least twice as large so that the copies add up to O(rows).
+                    // Readers may still be using the current one, so it is kept until the next update()
+                    const size_t capacity = std::max(estimatedRows, 2 * parsed.points.size());
+                    std::scoped_lock lock{grownTracksMutex};
+                    auto &grown = grownTracks.emplace_back(current, capacity);
+                    grown.append(std::span{parsed.points}.subspan(grown.size()));
+                    activeTrack.store(&grown, std::memory_order_release);
+                }
+
+                {
+                    std::scoped_lock lock{summaryMutex};
+                    boundingBox = parsed.summary.boundingBox;
+                    maximumAltitude = parsed.summary.maximumAltitude;
+                    minimumAltitude = parsed.summary.minimumAltitude;
+                }
+
+                if (!started) {
+                    started = true;
+                    if (!options.quiet) {
+                        std::cout << "Flight data available up to " << parsed.points.back().timestamp << "s after "
+                                  << duration_cast<milliseconds>(clock::now() - startTime).count()
+                                  << "ms, loading the rest in the background" << std::endl;
+                    }
+                    firstBlockPromise.set_value();
+                }
+
+                return !cancelLoad.load(std::memory_order_relaxed);
+            };
+
+            try {
+                ParsedFlight flight = DjiCsvParser::parseFileProgressive(path, options.parserThreads, onProgress);
+                if (cancelLoad)
+                    return;
+
+                if (!options.quiet)
+                    printReadStats(flight.points.size(), clock::now() - startTime);
+                if (flight.skippedRows > 0)
+                    std::cerr << "Skipped " << flight.skippedRows << " malformed flight data rows" << std::endl;
+
+                const FlightCache cache{path};
+                if (options.useCache && options.writeCache && cache.store(flight) && !options.quiet)
+                    std::cout << "Flight data cached to " << cache.path() << std::endl;
+
+                // Readers only access the points once the load is marked complete
+                flightDataPoints = std::move(flight.points);
+                scanForAnomalies();
+                lastTrack().finalize();
+                loadComplete.store(true, std::memory_order_release);
+            } catch (const std::exception &e) {
+                if (!started) {
+                    firstBlockPromise.set_exception(std::current_exception());
+                    return;
+                }
+                // The part loaded so far stays available, but the load is never marked complete
+                std::cerr << "Error while loading flight data: " << e.what() << std::endl;
+            }
+        });
+
+        // Rethrows any error raised before the first block was available
+        firstBlockFuture.get();
+    }
+
+    FlightTrack &DroneFlightData::lastTrack() {
+        std::scoped_lock lock{grownTracksMutex};
+        return grownTracks.empty() ? track : grownTracks.back();
+    }
+
+    std::vector<FlightDataPoint> DroneFlightData::loadFlightData(const std::filesystem::path &csvPath) {
+        const auto startTime = clock::now();
+
+        const FlightCache cache{csvPath};
+        std::optional<ParsedFlight> cachedFlight = options.useCache ? cache.load() : std::nullopt;
+        if (cachedFlight && !options.quiet) {
+            const auto duration = clock::now() - startTime;
+            std::cout << "Flight data loaded from cache in " << duration_cast<milliseconds>(duration).count() << "ms ("
+                      << cachedFlight->points.size() << " rows)" << std::endl;
+        }
+
+        ParsedFlight flight = cachedFlight ? std::move(*cachedFlight) : DjiCsvParser::parseFile(csvPath, options.parserThreads);
+
+        initialPosition = flight.initialPosition;
+        boundingBox = flight.summary.boundingBox;
+        maximumAltitude = flight.summary.maximumAltitude;
+        minimumAltitude = flight.summary.minimumAltitude;
+
+        if (!cachedFlight) {
+            if (!options.quiet)
+                printReadStats(flight.points.size(), clock::now() - startTime);
+            if (flight.skippedRows > 0)
+                std::cerr << "Skipped " << flight.skippedRows << " malformed flight data rows" << std::endl;
+
+            if (options.useCache && options.writeCache && cache.store(flight) && !options.quiet)
+                std::cout << "Flight data cached to " << cache.path() << std::endl;
+        }
+
+        return std::move(flight.points);
+    }
+
+    std::vector<FlightDataPoint> DroneFlightData::loadFlightDataLegacy(const std::string &csvPath) {
         const double feetToMeter = 0.3048;
         using namespace csv;
 
@@ -141,13 +427,9 @@ namespace dfv {
                     glm::radians(row["OSD.roll"].get<float>()));
         }
 
-        const auto endTime = clock::now();
-        const auto duration = duration_cast<milliseconds>(endTime - startTime);
-        std::cout << "Flight data read in " << duration.count() << "ms" << std::endl;
+        if (!options.quiet)
+            printReadStats(flightData.size(), clock::now() - startTime);
 
         return flightData;
     }
-
-
-
 } // namespace dfv
@@ -1,18 +1,60 @@
 #pragma once
 
+#include "anomaly_scanner.h"
+#include "compressed_path.h"
 #include "flight_data.h"
+#include "flight_track.h"
+#include "path_hierarchy.h"
+#include "telemetry_store.h"
 
+#include <atomic>
+#include <deque>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
 
 namespace dfv {
+    /**
+     * @brief Options controlling how a DroneFlightData loads its source file.
+     */
+    struct DroneFlightDataOptions {
+        bool legacyReader = false; //!< Parse the CSV with csv::CSVReader instead of the memory-mapped parser, for comparison
+        unsigned int parserThreads = 0; //!< The number of threads used to parse the CSV, 0 to use all hardware threads
+        bool useCache = true; //!< Load from and write to the binary sidecar cache next to the CSV
+        bool writeCache = true; //!< Write the cache when it is missing or stale, false to only read existing caches
+        bool progressive = false; //!< Return from load() as soon as the first rows are parsed and parse the rest in the background
+        /**
+         * @brief Keep the points delta-compressed in memory instead of as floats, for very long logs.
+         * @details Lookups decode the part of the path they need on demand, derived channels included, and there is no
+         * track. getPath() returns the finest simplified level of the path instead of every sample, decodePath() returns
+         * every sample. Progressive loading is not supported and is ignored.
+         */
+        bool compressPath = false;
+        bool headless = false; //!< Never index the telemetry, which is only used to draw the flight
+        bool scanAnomalies = true; //!< Scan the loaded flight for anomalies, getAnomalies() is empty otherwise
+        bool quiet = false; //!< Don't log the time taken by each step of the load, errors and warnings are still logged
+    };
+
     class DroneFlightData : public FlightData {
       public:
-        explicit DroneFlightData(std::filesystem::path path);
+        explicit DroneFlightData(std::filesystem::path path, DroneFlightDataOptions options = {});
+        ~DroneFlightData() override;
 
         bool load() override;
+        void update() override;
+        bool isLoadComplete() override;
+        seconds_f getValidUntil() override;
 
         Coordinate getInitialPosition() override;
         FlightDataPoint getPoint(seconds_f timestamp) override;
+        FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor &cursor) override;
+        void getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) override;
+        FlightPose getPose(seconds_f timestamp, PlaybackCursor &cursor) override;
+        DerivedChannels getChannels(seconds_f timestamp, PlaybackCursor &cursor) override;
+        TelemetryStore *getTelemetry() override;
+        const FlightTrack *getTrack() override;
+        std::span<const FlightAnomaly> getAnomalies() override;
         float getMaximumAltitude() override;
         float getMinimumAltitude() override;
 
@@ -21,17 +63,82 @@ namespace dfv {
         seconds_f getEndTime() override;
 
         FlightBoundingBox getBoundingBox() override;
-        std::vector<FlightDataPoint> &getPath() override;
-
+        const std::vector<FlightDataPoint> &getPath() override;
+        std::vector<FlightDataPoint> decodePath() override;
+        std::span<const FlightDataPoint> getSimplifiedPath(float maxError) override;
 
       private:
-        std::vector<FlightDataPoint> loadFlightData(const std::string &csvPath);
+        /**
+         * @brief Builds the simplified path hierarchy from the loaded points.
+         * @details Called by the first getSimplifiedPath(), or by the load when compressing the path.
+         */
+        void buildPathHierarchy();
+
+        /**
+         * @brief Scans the loaded points for anomalies.
+         */
+        void scanForAnomalies();
+
+        /**
+         * @brief Compresses the loaded points and releases them, getPath() returns the finest level of the path hierarchy.
+         */
+        void compressFlightData();
+
+        /**
+         * @brief Starts indexing the rows of the CSV for the telemetry store in the background.
+         * @details Called by the first getTelemetry(), which returns null until the store is published. The index uses
+         * at most MaxTelemetryThreads threads and stops early when the flight data is destroyed. The store is left empty
+         * if indexing fails.
+         */
+        void startTelemetryIndex();
+
+        /**
+         * @brief Starts parsing the CSV in the background, publishing the rows to the track as they are parsed.
+         * @details Returns once the first block of rows is available.
+         * @note Throws std::runtime_error if the file cannot be read or contains no valid rows.
+         */
+        void startProgressiveLoad();
+
+        /**
+         * @return The track readers interpolate, the last one grown by a progressive load.
+         */
+        const FlightTrack &currentTrack() const {
+            return *activeTrack.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @return The track a progressive load appends to, the last one grown.
+         */
+        FlightTrack &lastTrack();
+
+        std::vector<FlightDataPoint> loadFlightData(const std::filesystem::path &csvPath);
+        std::vector<FlightDataPoint> loadFlightDataLegacy(const std::string &csvPath);
 
         const std::filesystem::path path;
+        const DroneFlightDataOptions options;
         std::vector<FlightDataPoint> flightDataPoints;
+        FlightTrack track; //!< Structure-of-arrays copy of the flight data points, used for interpolation
+        // Tracks replacing the previous one when a progressive load outgrows its estimated row count. Readers may still
+        // be using the previous tracks, so they are only released by update(), called between reads
+        std::deque<FlightTrack> grownTracks;
+        std::atomic<const FlightTrack *> activeTrack{&track};
+        std::mutex grownTracksMutex; //!< Guards the deque of grown tracks, not the tracks themselves
+        PathHierarchy pathHierarchy; //!< Simplified versions of the flight data points, used for drawing
+        std::once_flag pathHierarchyBuilt;
+        CompressedPath compressedPath; //!< Used for interpolation instead of the track when compressing the path
+        std::optional<TelemetryStore> telemetry; //!< Every column of the CSV, decoded on demand
+        std::vector<FlightAnomaly> anomalies;
         std::optional<Coordinate> initialPosition;
         FlightBoundingBox boundingBox;
         float maximumAltitude = 0;
         float minimumAltitude = 0;
+
+        std::mutex summaryMutex; //!< Guards the bounding box and altitudes, which are updated while loading progressively
+        std::atomic<bool> loadComplete{true};
+        std::atomic<bool> cancelLoad{false}; //!< Set to stop a progressive load early
+        std::atomic<bool> telemetryReady{false}; //!< Publishes the telemetry store once indexed
+        std::once_flag telemetryIndexStarted;
+        std::future<void> telemetryIndex; //!< Cancelled with the load, and waited upon after it
+        std::future<void> progressiveLoad; //!< Declared last so that the load is waited upon before anything else is destroyed
     };
 } // namespace dfv
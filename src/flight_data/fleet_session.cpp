@@ -0,0 +1,238 @@
+#include "fleet_session.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+
+#include <utils/time_types.h>
+
+#include "geo_types.h"
+
+namespace dfv {
+    FleetSession::FleetSession(std::vector<std::filesystem::path> paths, DroneFlightDataOptions options,
+                               const size_t alignmentBand)
+        : paths(std::move(paths)), options(options), alignmentBand(alignmentBand) {}
+
+    bool FleetSession::load() {
+        const auto startTime = clock::now();
+
+        // A small pool of workers takes the next unloaded flight until none are left, so that a slow flight doesn't hold
+        // up the others. The hardware threads are split between the workers, each of which parses one file at a time.
+        const unsigned int threadCount = options.parserThreads != 0 ? options.parserThreads
+                                                                    : std::max(1u, std::thread::hardware_concurrency());
+        const auto workerCount = static_cast<unsigned int>(std::min<size_t>(paths.size(), threadCount));
+
+        DroneFlightDataOptions flightOptions = options;
+        flightOptions.progressive = false;
+        flightOptions.headless = true;
+        flightOptions.parserThreads = std::max(1u, threadCount / std::max(1u, workerCount));
+
+        std::vector<std::unique_ptr<DroneFlightData>> loaded(paths.size());
+        std::vector<nanoseconds> loadTimes(paths.size());
+        std::atomic<size_t> nextFlight{0};
+        const auto loadFlights = [&] {
+            for (size_t i = nextFlight++; i < paths.size(); i = nextFlight++) {
+                const auto flightStart = clock::now();
+                auto memberOptions = flightOptions;
+                memberOptions.scanAnomalies = options.scanAnomalies && i == 0;
+                auto flight = std::make_unique<DroneFlightData>(paths[i], memberOptions);
+                if (flight->load())
+                    loaded[i] = std::move(flight);
+                else
+                    std::cerr << "Leaving " << paths[i] << " out of the fleet" << std::endl;
+                loadTimes[i] = clock::now() - flightStart;
+            }
+        };
+
+        std::vector<std::future<void>> workers;
+        workers.reserve(workerCount);
+        for (unsigned int worker = 0; worker < workerCount; worker++)
+            workers.push_back(std::async(std::launch::async, loadFlights));
+        for (auto &worker : workers)
+            worker.get();
+
+        for (auto &flight : loaded) {
+            if (flight)
+                flights.push_back({.data = std::move(flight), .timeOffset = 0.f, .offsetX = 0.f, .offsetZ = 0.f});
+        }
+        if (flights.empty()) {
+            std::cerr << "Error while loading flight data: no flight of the fleet could be loaded" << std::endl;
+            return false;
+        }
+
+        alignFlights();
+        if (alignmentBand > 0)
+            compareFlights();
+
+        const auto slowest = std::max_element(loadTimes.begin(), loadTimes.end());
+        std::cout << "Fleet of " << flights.size() << " flights loaded in "
+                  << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms (slowest flight "
+                  << duration_cast<milliseconds>(*slowest).count() << "ms)" << std::endl;
+        return true;
+    }
+
+    void FleetSession::alignFlights() {
+        origin = flights.front().data->getInitialPosition();
+        boundingBox = flights.front().data->getBoundingBox();
+        maximumAltitude = flights.front().data->getMaximumAltitude();
+        minimumAltitude = flights.front().data->getMinimumAltitude();
+
+        size_t pointCount = 0;
+        for (auto &flight : flights) {
+            auto &data = *flight.data;
+
+            // Positions are scaled differences of latitude and longitude, so moving them to another origin is a translation
+            const Coordinate offset = calculateRelativePosition(data.getInitialPosition(), origin);
+            flight.offsetX = static_cast<float>(offset.lon);
+            flight.offsetZ = static_cast<float>(offset.lat);
+            flight.timeOffset = data.getStartTime().count();
+            endTime = std::max(endTime, data.getEndTime().count() - flight.timeOffset);
+
+            const auto box = data.getBoundingBox();
+            boundingBox.llLat = std::min(boundingBox.llLat, box.llLat);
+            boundingBox.llLon = std::min(boundingBox.llLon, box.llLon);
+            boundingBox.urLat = std::max(boundingBox.urLat, box.urLat);
+            boundingBox.urLon = std::max(boundingBox.urLon, box.urLon);
+            maximumAltitude = std::max(maximumAltitude, data.getMaximumAltitude());
+            minimumAltitude = std::min(minimumAltitude, data.getMinimumAltitude());
+
+            pointCount += data.getPath().size();
+        }
+
+        path.reserve(pointCount);
+        for (const auto &flight : flights) {
+            flightPathStart.push_back(path.size());
+            for (const auto &point : flight.data->getPath())
+                path.push_back(toSession(flight, point));
+        }
+        flightPathStart.push_back(path.size());
+
+        const auto &first = flights.front();
+        for (auto anomaly : first.data->getAnomalies()) {
+            anomaly.startTime -= first.timeOffset;
+            anomaly.endTime -= first.timeOffset;
+            anomalies.push_back(anomaly);
+        }
+    }
+
+    void FleetSession::compareFlights() {
+        // Each alignment runs on a single thread, so the flights are aligned concurrently by a pool of workers
+        const double originLatitude = flights.front().data->getInitialPosition().lat;
+        const unsigned int threadCount = options.parserThreads != 0 ? options.parserThreads
+                                                                    : std::max(1u, std::thread::hardware_concurrency());
+        const auto workerCount = static_cast<unsigned int>(std::min<size_t>(flights.size() - 1, threadCount));
+
+        alignments.resize(flights.size() - 1);
+        std::vector<nanoseconds> alignTimes(flights.size() - 1);
+        std::atomic<size_t> nextFlight{1};
+        const auto alignFlights = [&] {
+            for (size_t flight = nextFlight++; flight < flights.size(); flight = nextFlight++) {
+                const auto startTime = clock::now();
+                alignments[flight - 1] = alignPaths(getFlightPath(0), getFlightPath(flight), originLatitude, alignmentBand);
+                alignTimes[flight - 1] = clock::now() - startTime;
+            }
+        };
+
+        std::vector<std::future<void>> workers;
+        workers.reserve(workerCount);
+        for (unsigned int worker = 0; worker < workerCount; worker++)
+            workers.push_back(std::async(std::launch::async, alignFlights));
+        for (auto &worker : workers)
+            worker.get();
+
+        for (size_t flight = 1; flight < flights.size(); flight++) {
+            const auto &alignment = alignments[flight - 1];
+            std::cout << "Flight " << flight + 1 << " aligned in "
+                      << duration_cast<milliseconds>(alignTimes[flight - 1]).count() << "ms (mean deviation "
+                      << alignment.meanDeviation << "m, max " << alignment.maxDeviation << "m)" << std::endl;
+        }
+    }
+
+    FlightDataPoint FleetSession::toSession(const Flight &flight, FlightDataPoint point) {
+        point.timestamp -= flight.timeOffset;
+        point.x += flight.offsetX;
+        point.z += flight.offsetZ;
+        return point;
+    }
+
+    size_t FleetSession::getFlightCount() {
+        return flights.size();
+    }
+
+    std::span<const FlightDataPoint> FleetSession::getFlightPath(const size_t flight) {
+        // The path holds every flight in the frame of the session, one after the other
+        return std::span{path}.subspan(flightPathStart[flight], flightPathStart[flight + 1] - flightPathStart[flight]);
+    }
+
+    FlightDataPoint FleetSession::getFlightPoint(const size_t flight, seconds_f timestamp, PlaybackCursor &cursor) {
+        const auto &fleetFlight = flights[flight];
+        const seconds_f flightTimestamp{timestamp.count() + fleetFlight.timeOffset};
+        return toSession(fleetFlight, fleetFlight.data->getPoint(flightTimestamp, cursor));
+    }
+
+    std::optional<float> FleetSession::getFlightDeviation(const size_t flight, seconds_f timestamp) {
+        if (flight == 0 || flight > alignments.size() || alignments[flight - 1].empty())
+            return std::nullopt;
+        return alignments[flight - 1].deviationAt(timestamp.count());
+    }
+
+    Coordinate FleetSession::getInitialPosition() {
+        return origin;
+    }
+
+    FlightDataPoint FleetSession::getPoint(seconds_f timestamp) {
+        PlaybackCursor cursor{};
+        return getFlightPoint(0, timestamp, cursor);
+    }
+
+    FlightDataPoint FleetSession::getPoint(seconds_f timestamp, PlaybackCursor &cursor) {
+        return getFlightPoint(0, timestamp, cursor);
+    }
+
+    FlightPose FleetSession::getPose(seconds_f timestamp, PlaybackCursor &cursor) {
+        const auto &flight = flights.front();
+        auto pose = flight.data->getPose(seconds_f{timestamp.count() + flight.timeOffset}, cursor);
+        pose.x += flight.offsetX;
+        pose.z += flight.offsetZ;
+        return pose;
+    }
+
+    DerivedChannels FleetSession::getChannels(seconds_f timestamp, PlaybackCursor &cursor) {
+        const auto &flight = flights.front();
+        return flight.data->getChannels(seconds_f{timestamp.count() + flight.timeOffset}, cursor);
+    }
+
+    std::span<const FlightAnomaly> FleetSession::getAnomalies() {
+        return anomalies;
+    }
+
+    float FleetSession::getMaximumAltitude() {
+        return maximumAltitude;
+    }
+
+    float FleetSession::getMinimumAltitude() {
+        return minimumAltitude;
+    }
+
+    seconds_f FleetSession::getDuration() {
+        return seconds_f{endTime};
+    }
+
+    seconds_f FleetSession::getStartTime() {
+        return seconds_f{0.f};
+    }
+
+    seconds_f FleetSession::getEndTime() {
+        return seconds_f{endTime};
+    }
+
+    FlightBoundingBox FleetSession::getBoundingBox() {
+        return boundingBox;
+    }
+
+    const std::vector<FlightDataPoint> &FleetSession::getPath() {
+        return path;
+    }
+} // namespace dfv
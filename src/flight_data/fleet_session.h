@@ -0,0 +1,105 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "drone_flight_data.h"
+#include "flight_alignment.h"
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief Several flight logs shown together, loaded concurrently and aligned in space and time.
+     * @details All flights are moved to the frame of the first one, whose initial position is the origin of the session,
+     * and their start times are aligned to the start of the session. The first flight is the one returned by getPoint(),
+     * the others are available through getFlightPoint(). The bounding box, altitudes and path cover every flight, so
+     * that a single map load covers them all.
+     *
+     * Only the path and the samples of the flights are forwarded, so they are loaded headless, and only the first flight
+     * is scanned for anomalies, which are reported on the timeline of the session.
+     */
+    class FleetSession : public FlightData {
+      public:
+        /**
+         * @param paths The flight logs to load, at least one.
+         * @param options The options each log is loaded with, progressive loading is not supported and is ignored.
+         * @param alignmentBand If not 0, every flight is aligned to the first one once loaded, with this band half-width
+         * in samples, see alignPaths().
+         */
+        explicit FleetSession(std::vector<std::filesystem::path> paths, DroneFlightDataOptions options = {},
+                              size_t alignmentBand = 0);
+
+        /**
+         * @brief Loads every flight concurrently, flights that fail to load are left out of the session.
+         * @return True if at least one flight was loaded, false otherwise.
+         */
+        bool load() override;
+
+        size_t getFlightCount() override;
+        FlightDataPoint getFlightPoint(size_t flight, seconds_f timestamp, PlaybackCursor &cursor) override;
+        std::span<const FlightDataPoint> getFlightPath(size_t flight) override;
+        std::optional<float> getFlightDeviation(size_t flight, seconds_f timestamp) override;
+
+        Coordinate getInitialPosition() override;
+        FlightDataPoint getPoint(seconds_f timestamp) override;
+        FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor &cursor) override;
+        FlightPose getPose(seconds_f timestamp, PlaybackCursor &cursor) override;
+        DerivedChannels getChannels(seconds_f timestamp, PlaybackCursor &cursor) override;
+        std::span<const FlightAnomaly> getAnomalies() override;
+        float getMaximumAltitude() override;
+        float getMinimumAltitude() override;
+
+        seconds_f getDuration() override;
+        seconds_f getStartTime() override;
+        seconds_f getEndTime() override;
+
+        FlightBoundingBox getBoundingBox() override;
+
+        /**
+         * @brief Returns the paths of all flights one after the other, in the frame of the session.
+         */
+        const std::vector<FlightDataPoint> &getPath() override;
+
+      private:
+        /**
+         * @brief A loaded flight and how it is aligned to the session.
+         */
+        struct Flight {
+            std::unique_ptr<DroneFlightData> data;
+            float timeOffset; //!< Added to session timestamps to obtain the flight's own timestamps
+            float offsetX; //!< Added to the flight's x coordinates to move them to the frame of the session
+            float offsetZ; //!< Added to the flight's z coordinates to move them to the frame of the session
+        };
+
+        /**
+         * @brief Converts a point of the given flight to the frame and timeline of the session.
+         */
+        static FlightDataPoint toSession(const Flight &flight, FlightDataPoint point);
+
+        /**
+         * @brief Aligns the loaded flights and merges their summaries and paths.
+         */
+        void alignFlights();
+
+        /**
+         * @brief Aligns the path of every flight after the first to the path of the first one.
+         */
+        void compareFlights();
+
+        const std::vector<std::filesystem::path> paths;
+        const DroneFlightDataOptions options;
+        const size_t alignmentBand;
+        std::vector<Flight> flights;
+        std::vector<PathAlignment> alignments; //!< The alignment of the first flight to each of the others
+        std::vector<FlightAnomaly> anomalies; //!< The anomalies of the first flight, on the timeline of the session
+
+        Coordinate origin{};
+        FlightBoundingBox boundingBox{};
+        float maximumAltitude = 0;
+        float minimumAltitude = 0;
+        float endTime = 0;
+        std::vector<FlightDataPoint> path;
+        std::vector<size_t> flightPathStart; //!< The index of each flight's first point in path, and the size of path
+    };
+} // namespace dfv
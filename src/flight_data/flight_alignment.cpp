@@ -0,0 +1,190 @@
+#include "flight_alignment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "geo_types.h"
+#include "interpolation.h"
+
+namespace dfv {
+    namespace {
+        constexpr double Unreachable = std::numeric_limits<double>::infinity();
+
+        /**
+         * @brief Which neighbour a cell's best match path comes from.
+         */
+        enum Step : uint8_t {
+            Diagonal, //!< From (i - 1, j - 1)
+            Up, //!< From (i - 1, j), the reference sample is matched again
+            Left, //!< From (i, j - 1), the candidate sample is matched again
+        };
+
+        /**
+         * @brief Returns the distance between two samples in meters.
+         */
+        float distance(const FlightDataPoint &a, const FlightDataPoint &b, const UnitScale scale) {
+            const float horizontal = horizontalDistance(a.x - b.x, a.z - b.z, scale);
+            const float dy = a.y - b.y;
+            return std::sqrt(horizontal * horizontal + dy * dy);
+        }
+
+        /**
+         * @brief Dynamic time warping restricted to a band around the diagonal of the cost matrix.
+         * @details Rows are reference samples and columns candidate samples. The band cells of each row are contiguous
+         * and their steps are stored one row after the other.
+         */
+        class BandedWarping {
+          public:
+            BandedWarping(std::span<const FlightDataPoint> reference, std::span<const FlightDataPoint> candidate,
+                          const UnitScale scale, size_t band)
+                : reference(reference), candidate(candidate), scale(scale), rowLo(reference.size()),
+                  rowHi(reference.size()), rowStart(reference.size() + 1) {
+                const size_t n = reference.size();
+                const size_t m = candidate.size();
+
+                // A row's band must overlap the next one's for the path to get through, which needs a half-width of
+                // at least the slope of the diagonal
+                const double slope = static_cast<double>(m - 1) / static_cast<double>(std::max<size_t>(n - 1, 1));
+                band = std::max(band, static_cast<size_t>(std::ceil(slope)));
+
+                for (size_t i = 0; i < n; i++) {
+                    const auto center = static_cast<size_t>(std::llround(static_cast<double>(i) * slope));
+                    rowLo[i] = center > band ? center - band : 0;
+                    rowHi[i] = std::min(center + band, m - 1);
+                    rowStart[i + 1] = rowStart[i] + rowHi[i] - rowLo[i] + 1;
+                    bandWidth = std::max(bandWidth, rowHi[i] - rowLo[i] + 1);
+                }
+                steps.resize(rowStart[n]);
+            }
+
+            /**
+             * @brief Computes the steps of every band cell, one row after the other.
+             * @details Only the costs of the previous row are kept, the band moves right from one row to the next.
+             */
+            void run() {
+                std::vector<double> previous(bandWidth, Unreachable);
+                std::vector<double> current(bandWidth, Unreachable);
+
+                for (size_t i = 0; i < reference.size(); i++) {
+                    // The costs of the previous row at column j, unreachable outside its band
+                    const auto above = [&](const size_t j) {
+                        if (i == 0 || j < rowLo[i - 1] || j > rowHi[i - 1])
+                            return Unreachable;
+                        return previous[j - rowLo[i - 1]];
+                    };
+
+                    for (size_t j = rowLo[i]; j <= rowHi[i]; j++) {
+                        const size_t k = j - rowLo[i];
+                        const double cost = distance(reference[i], candidate[j], scale);
+                        if (i == 0 && j == 0) {
+                            current[k] = cost;
+                            continue;
+                        }
+
+                        const double up = above(j);
+                        const double diagonal = j > 0 ? above(j - 1) : Unreachable;
+                        const double leftNeighbour = k > 0 ? current[k - 1] : Unreachable;
+
+                        Step step = Diagonal;
+                        double best = diagonal;
+                        if (up < best) {
+                            step = Up;
+                            best = up;
+                        }
+                        if (leftNeighbour < best) {
+                            step = Left;
+                            best = leftNeighbour;
+                        }
+                        steps[rowStart[i] + k] = step;
+                        current[k] = best + cost;
+                    }
+                    std::swap(previous, current);
+                }
+            }
+
+            /**
+             * @brief Follows the steps back from the last cell, averaging the distance of each reference sample from
+             * the candidate samples it was matched with.
+             */
+            PathAlignment traceBack() const {
+                const size_t n = reference.size();
+                PathAlignment alignment{};
+                alignment.timestamps.resize(n);
+                alignment.deviations.assign(n, 0.f);
+                std::vector<uint32_t> matches(n, 0);
+
+                size_t i = n - 1;
+                size_t j = candidate.size() - 1;
+                while (true) {
+                    alignment.deviations[i] += distance(reference[i], candidate[j], scale);
+                    matches[i]++;
+                    if (i == 0 && j == 0)
+                        break;
+
+                    switch (steps[rowStart[i] + j - rowLo[i]]) {
+                        case Diagonal:
+                            i--;
+                            j--;
+                            break;
+                        case Up:
+                            i--;
+                            break;
+                        case Left:
+                            j--;
+                            break;
+                    }
+                }
+
+                double total = 0.0;
+                for (size_t k = 0; k < n; k++) {
+                    alignment.timestamps[k] = reference[k].timestamp;
+                    alignment.deviations[k] /= static_cast<float>(matches[k]);
+                    alignment.maxDeviation = std::max(alignment.maxDeviation, alignment.deviations[k]);
+                    total += alignment.deviations[k];
+                }
+                alignment.meanDeviation = static_cast<float>(total / static_cast<double>(n));
+                return alignment;
+            }
+
+          private:
+            std::span<const FlightDataPoint> reference;
+            std::span<const FlightDataPoint> candidate;
+            UnitScale scale;
+
+            // The band of each row
+            std::vector<size_t> rowLo;
+            std::vector<size_t> rowHi;
+            std::vector<size_t> rowStart; //!< The offset of each row's band in steps
+            size_t bandWidth = 0; //!< The most cells in the band of a row
+            std::vector<uint8_t> steps; //!< The Step of every band cell
+        };
+    } // namespace
+
+    bool PathAlignment::empty() const {
+        return timestamps.empty();
+    }
+
+    float PathAlignment::deviationAt(const float timestamp) const {
+        const auto next = std::upper_bound(timestamps.begin(), timestamps.end(), timestamp);
+        if (next == timestamps.begin())
+            return deviations.front();
+        if (next == timestamps.end())
+            return deviations.back();
+
+        const auto segment = static_cast<size_t>(next - timestamps.begin()) - 1;
+        const float t = (timestamp - timestamps[segment]) / (timestamps[segment + 1] - timestamps[segment]);
+        return lerp(deviations[segment], deviations[segment + 1], t);
+    }
+
+    PathAlignment alignPaths(std::span<const FlightDataPoint> reference, std::span<const FlightDataPoint> candidate,
+                             const double originLatitude, const size_t band) {
+        if (reference.empty() || candidate.empty())
+            return {};
+
+        BandedWarping warping{reference, candidate, unitScaleAt(originLatitude), band};
+        warping.run();
+        return warping.traceBack();
+    }
+} // namespace dfv
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief How far each sample of a reference path is from the samples of another path it was matched with.
+     */
+    struct PathAlignment {
+        std::vector<float> timestamps; //!< The timestamps of the reference samples
+        std::vector<float> deviations; //!< The mean distance of each reference sample from its matches, in meters
+        float meanDeviation{0.f}; //!< The mean deviation over all reference samples, in meters
+        float maxDeviation{0.f}; //!< In meters
+
+        bool empty() const;
+
+        /**
+         * @brief Interpolates the deviation at the given timestamp of the reference path.
+         * @note Timestamps outside the path are clamped. Must not be called on an empty alignment.
+         */
+        float deviationAt(float timestamp) const;
+    };
+
+    /**
+     * @brief Aligns two paths in the same frame with dynamic time warping, matching every sample of each path with the
+     * samples of the other path that minimize the total distance between matches, in order.
+     * @param originLatitude The latitude both paths are relative to, which sets the meters per unit of the positions.
+     * @param band The Sakoe-Chiba band half-width: a sample may only be matched with samples at most this many indices
+     * away from the proportional position in the other path. It is widened if needed to reach the end of both paths.
+     * @details The band is computed one row after the other, keeping only the costs of the previous row, and the match
+     * path is traced back from one byte per band cell, so memory is O(n * band). A band is too narrow to be worth
+     * splitting across threads, callers aligning several paths align them concurrently instead.
+     * @return The alignment of the reference path, empty if either path is.
+     */
+    PathAlignment alignPaths(std::span<const FlightDataPoint> reference, std::span<const FlightDataPoint> candidate,
+                             double originLatitude, size_t band = 64);
+} // namespace dfv
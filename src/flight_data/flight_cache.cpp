@@ -0,0 +1,133 @@
+#include "flight_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include <utils/mapped_file.h>
+#include <utils/temp_path.h>
+
+namespace dfv {
+    static_assert(std::is_trivially_copyable_v<FlightCache::Header>, "The cache header is written as raw bytes");
+    static_assert(std::is_trivially_copyable_v<FlightDataPoint>, "Flight data points are written as raw bytes");
+
+    FlightCache::FlightCache(const std::filesystem::path &sourcePath)
+        : sourcePath(sourcePath), cachePath(std::filesystem::path{sourcePath} += ".dfvbin") {}
+
+    std::optional<ParsedFlight> FlightCache::load() const {
+        try {
+            if (!std::filesystem::is_regular_file(cachePath))
+                return std::nullopt;
+
+            const MappedFile file{cachePath};
+            const auto data = file.data();
+            if (data.size() < sizeof(Header))
+                return std::nullopt;
+
+            Header header;
+            std::memcpy(&header, data.data(), sizeof(Header));
+            if (!isValid(header) || data.size() != sizeof(Header) + header.pointCount * sizeof(FlightDataPoint))
+                return std::nullopt;
+
+            ParsedFlight flight{};
+            flight.initialPosition = header.initialPosition;
+            flight.summary.boundingBox = header.boundingBox;
+            flight.summary.minimumAltitude = header.minimumAltitude;
+            flight.summary.maximumAltitude = header.maximumAltitude;
+            flight.skippedRows = header.skippedRows;
+
+            flight.points.resize(header.pointCount);
+            std::memcpy(flight.points.data(), data.data() + sizeof(Header), header.pointCount * sizeof(FlightDataPoint));
+
+            return flight;
+        } catch (const std::exception &e) {
+            std::cerr << "Failed to read flight cache " << cachePath << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    std::optional<FlightCache::Header> FlightCache::loadHeader() const {
+        std::ifstream file{cachePath, std::ios::binary};
+        if (!file)
+            return std::nullopt;
+
+        Header header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(Header)) || !isValid(header))
+            return std::nullopt;
+
+        return header;
+    }
+
+    bool FlightCache::store(const ParsedFlight &flight) const {
+        const auto stamp = sourceStamp();
+        if (!stamp)
+            return false;
+
+        const Header header{.magic = Magic,
+                            .version = Version,
+                            .pointSize = sizeof(FlightDataPoint),
+                            .sourceSize = stamp->first,
+                            .sourceModifiedTime = stamp->second,
+                            .pointCount = flight.points.size(),
+                            .skippedRows = flight.skippedRows,
+                            .initialPosition = flight.initialPosition,
+                            .boundingBox = flight.summary.boundingBox,
+                            .minimumAltitude = flight.summary.minimumAltitude,
+                            .maximumAltitude = flight.summary.maximumAltitude,
+                            .startTimestamp = flight.points.empty() ? 0.f : flight.points.front().timestamp,
+                            .endTimestamp = flight.points.empty() ? 0.f : flight.points.back().timestamp};
+
+        // Write to a temporary file first so a concurrent or interrupted write never leaves a truncated cache behind
+        const auto tempPath = uniqueTempPath(cachePath);
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+            file.write(reinterpret_cast<const char *>(flight.points.data()),
+                       static_cast<std::streamsize>(flight.points.size() * sizeof(FlightDataPoint)));
+            if (!file) {
+                std::cerr << "Failed to write flight cache " << cachePath << std::endl;
+                file.close();
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec) {
+            std::cerr << "Failed to write flight cache " << cachePath << ": " << ec.message() << std::endl;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    const std::filesystem::path &FlightCache::path() const {
+        return cachePath;
+    }
+
+    std::optional<std::pair<uint64_t, int64_t>> FlightCache::sourceStamp() const {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(sourcePath, ec);
+        if (ec)
+            return std::nullopt;
+
+        const auto modifiedTime = std::filesystem::last_write_time(sourcePath, ec);
+        if (ec)
+            return std::nullopt;
+
+        return std::pair{static_cast<uint64_t>(size), static_cast<int64_t>(modifiedTime.time_since_epoch().count())};
+    }
+
+    bool FlightCache::isValid(const Header &header) const {
+        if (header.magic != Magic || header.version != Version || header.pointSize != sizeof(FlightDataPoint))
+            return false;
+
+        const auto stamp = sourceStamp();
+        return stamp && header.sourceSize == stamp->first && header.sourceModifiedTime == stamp->second;
+    }
+} // namespace dfv
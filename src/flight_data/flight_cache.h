@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "dji_csv_parser.h"
+
+namespace dfv {
+    /**
+     * @brief A binary sidecar cache of a parsed flight log, stored next to the source file with a .dfvbin extension.
+     * @details The cache holds a header with the flight summary, followed by the packed array of points.
+     * It is tied to the size and modification time of the source file and is ignored once either changes.
+     * @note The cache is written in the native byte order and is not meant to be moved across machines.
+     */
+    class FlightCache {
+      public:
+        /**
+         * @brief The header at the start of a cache file.
+         */
+        struct Header {
+            std::array<char, 8> magic;
+            uint32_t version;
+            uint32_t pointSize; //!< sizeof(FlightDataPoint) when the cache was written, guards against layout changes
+            uint64_t sourceSize; //!< The size of the source file in bytes
+            int64_t sourceModifiedTime; //!< The last write time of the source file, in file clock ticks
+            uint64_t pointCount;
+            uint64_t skippedRows;
+            Coordinate initialPosition;
+            FlightBoundingBox boundingBox;
+            float minimumAltitude;
+            float maximumAltitude;
+            float startTimestamp; //!< The timestamp of the first point
+            float endTimestamp; //!< The timestamp of the last point
+        };
+
+        static constexpr std::array<char, 8> Magic = {'D', 'F', 'V', 'B', 'I', 'N', '\0', '\0'};
+        static constexpr uint32_t Version = 2; //!< Must be bumped whenever the layout of the file changes
+
+        /**
+         * @brief Constructs a cache for the given source flight log.
+         */
+        explicit FlightCache(const std::filesystem::path &sourcePath);
+
+        /**
+         * @brief Maps the cache file and reads the flight from it.
+         * @return The cached flight, or an empty optional if the cache is missing, corrupted or stale.
+         */
+        std::optional<ParsedFlight> load() const;
+
+        /**
+         * @brief Writes the given flight to the cache file, replacing any existing one.
+         * @return True if the cache was written successfully, false otherwise.
+         */
+        bool store(const ParsedFlight &flight) const;
+
+        /**
+         * @brief Reads only the header of the cache file.
+         * @return The header, or an empty optional if the cache is missing, corrupted or stale.
+         */
+        std::optional<Header> loadHeader() const;
+
+        const std::filesystem::path &path() const;
+
+      private:
+        /**
+         * @brief Returns the size and modification time of the source file, to be stored in or checked against a header.
+         */
+        std::optional<std::pair<uint64_t, int64_t>> sourceStamp() const;
+
+        /**
+         * @brief Checks that a header belongs to the current version of the source file.
+         */
+        bool isValid(const Header &header) const;
+
+        const std::filesystem::path sourcePath; //!< The path to the source flight log
+        const std::filesystem::path cachePath; //!< The path to the cache file
+    };
+} // namespace dfv
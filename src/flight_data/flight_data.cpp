@@ -0,0 +1,38 @@
+#include "flight_data.h"
+
+#include <cmath>
+
+#include "interpolation.h"
+
+namespace dfv {
+    void FlightData::getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) {
+        PlaybackCursor cursor{};
+        for (size_t i = 0; i < timestamps.size(); i++)
+            points[i] = getPoint(timestamps[i], cursor);
+    }
+
+    FlightPose FlightData::getPose(seconds_f timestamp, PlaybackCursor &cursor) {
+        const auto point = getPoint(timestamp, cursor);
+        const auto q = attitudeQuaternion(point.yaw, point.pitch, point.roll);
+        return {.x = point.x, .y = point.y, .z = point.z, .qw = q[0], .qx = q[1], .qy = q[2], .qz = q[3]};
+    }
+
+    std::vector<FlightDataPoint> FlightData::resample(const seconds_f start, const seconds_f end, const float sampleRate) {
+        if (!(sampleRate > 0.f) || end < start)
+            return {};
+
+        // Timestamps are computed from the sample index rather than accumulated, to avoid drifting on long flights
+        const auto sampleCount = static_cast<size_t>(std::floor((end - start).count() * sampleRate)) + 1;
+        std::vector<seconds_f> timestamps(sampleCount);
+        for (size_t i = 0; i < sampleCount; i++)
+            timestamps[i] = start + seconds_f{static_cast<float>(i) / sampleRate};
+
+        std::vector<FlightDataPoint> points(sampleCount);
+        getPoints(timestamps, points);
+        return points;
+    }
+
+    std::vector<FlightDataPoint> FlightData::resample(const float sampleRate) {
+        return resample(getStartTime(), getEndTime(), sampleRate);
+    }
+} // namespace dfv
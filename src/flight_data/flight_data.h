@@ -1,12 +1,17 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 
 #include "geo_types.h"
 #include <utils/time_types.h>
 
 namespace dfv {
+    class FlightTrack;
+    class TelemetryStore;
+
     /**
      * @brief A struct representing a single point of flight data.
      * @details Units are in meters and radians.
@@ -27,6 +32,60 @@ namespace dfv {
         float roll; //!< Angle of rotation about the z-axis
     };
 
+    /**
+     * @brief The placement of the flying object, with its attitude as a quaternion rather than angles.
+     */
+    struct FlightPose {
+        float x; //!< Position in the x-axis, corresponds to longitude in our plane
+        float y; //!< Position in the y-axis, corresponds to altitude in our plane
+        float z; //!< Position in the z-axis, corresponds to latitude in our plane
+        // Unit quaternion rotating about the y-axis by the yaw, then the x-axis by the pitch, then the z-axis by the roll
+        float qw;
+        float qx;
+        float qy;
+        float qz;
+    };
+
+    /**
+     * @brief Channels derived from consecutive flight data points.
+     * @details Rates are computed from each sample and the one before it.
+     */
+    struct DerivedChannels {
+        float groundSpeed; //!< Horizontal speed in m/s
+        float verticalSpeed; //!< Vertical speed in m/s, positive when climbing
+        float acceleration; //!< Rate of change of the 3D speed in m/s^2
+        float distance; //!< 3D distance travelled since the start of the flight in meters
+        float headingRate; //!< Rate of change of the yaw in rad/s
+    };
+
+    /**
+     * @brief The kinds of anomalies detected in a flight.
+     */
+    enum class AnomalyType : uint8_t {
+        AltitudeDrop, //!< The altitude fell faster than a drone can descend
+        AttitudeSpike, //!< The yaw, pitch or roll changed faster than a drone can turn
+        GpsJump, //!< The position moved faster than a drone can fly
+        SampleGap, //!< No samples were logged for longer than the logging interval
+    };
+
+    /**
+     * @brief A run of consecutive steps between samples showing the same anomaly.
+     */
+    struct FlightAnomaly {
+        AnomalyType type;
+        float startTime; //!< The timestamp the first anomalous step starts at, in seconds
+        float endTime; //!< The timestamp the last anomalous step ends at, in seconds
+        float peak; //!< The largest value of the anomaly's measure over the run, see AnomalyThresholds
+    };
+
+    /**
+     * @brief Remembers where the last lookup into the flight data landed, so that sequential lookups can resume from there.
+     * @details A cursor is only meaningful for the flight data it was used with and must not be shared between them.
+     */
+    struct PlaybackCursor {
+        size_t segment{0}; //!< The index of the segment the last lookup landed in
+    };
+
     struct FlightBoundingBox {
         double llLat; //!< Lower left latitude
         double llLon; //!< Lower left longitude
@@ -44,12 +103,142 @@ namespace dfv {
 
         /**
          * @brief Loads the flight data. It is recommended to perform expensive operations here (e.g. parsing a file).
+         * @details Implementations loading progressively may return as soon as a first part of the flight is available and
+         * keep loading in the background, see isLoadComplete().
          * @return True if successful, false otherwise.
          */
         virtual bool load() = 0;
 
+        /**
+         * @brief Called by the visualizer once per frame before any point is read, lets sources take in new data.
+         */
+        virtual void update() {}
+
+        /**
+         * @brief Returns whether the whole flight has been loaded.
+         * @details While loading, the end time, duration, bounding box and altitudes describe the part of the flight loaded
+         * so far and grow as more of it arrives, while getPath() is only available once the load is complete.
+         */
+        virtual bool isLoadComplete() {
+            return true;
+        }
+
+        /**
+         * @brief Returns the timestamp up to which points are available, which only ever advances while loading.
+         */
+        virtual seconds_f getValidUntil() {
+            return getEndTime();
+        }
+
         virtual Coordinate getInitialPosition() = 0;
         virtual FlightDataPoint getPoint(seconds_f timestamp) = 0;
+
+        /**
+         * @brief Returns the point at the given timestamp, starting the lookup from where the cursor was left.
+         * @details Meant for playback, where consecutive timestamps are close to each other: the lookup walks from the last
+         * segment instead of searching the whole flight. The cursor is updated to the segment of the returned point.
+         */
+        virtual FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor & /*cursor*/) {
+            return getPoint(timestamp);
+        }
+
+        /**
+         * @brief Returns the points at many timestamps at once.
+         * @param timestamps The timestamps to evaluate, ideally sorted in increasing order.
+         * @param points The output points, must be at least as large as timestamps.
+         * @details Meant for anything that needs many samples at once (plots, trails, exports): implementations resolve
+         * sorted timestamps in a single walk over the data instead of searching it once per timestamp.
+         */
+        virtual void getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points);
+
+        /**
+         * @brief Samples the flight at a fixed rate between the given timestamps, both included.
+         * @param sampleRate The number of samples per second.
+         */
+        std::vector<FlightDataPoint> resample(seconds_f start, seconds_f end, float sampleRate);
+
+        /**
+         * @brief Samples the whole flight at a fixed rate.
+         * @param sampleRate The number of samples per second.
+         */
+        std::vector<FlightDataPoint> resample(float sampleRate);
+
+        /**
+         * @brief Returns the pose at the given timestamp, starting the lookup from where the cursor was left.
+         * @details Unlike getPoint(), sources may interpolate the pose along a smooth curve. The default converts the
+         * linearly interpolated point.
+         */
+        virtual FlightPose getPose(seconds_f timestamp, PlaybackCursor &cursor);
+
+        /**
+         * @brief Returns the derived channels at the given timestamp, starting the lookup from where the cursor was left.
+         * @details Passing the cursor just used with getPoint() makes the lookup free. Sources that don't derive channels
+         * return zeros.
+         */
+        virtual DerivedChannels getChannels(seconds_f /*timestamp*/, PlaybackCursor & /*cursor*/) {
+            return {};
+        }
+
+        /**
+         * @brief Returns the number of flights in the data source, sources with more than one show them side by side.
+         */
+        virtual size_t getFlightCount() {
+            return 1;
+        }
+
+        /**
+         * @brief Returns the point of one of the flights at the given timestamp, starting the lookup from the cursor.
+         * @param flight The index of the flight, flight 0 is the one returned by getPoint().
+         * @details All flights share the frame and timeline of getPoint(), each needs its own cursor.
+         */
+        virtual FlightDataPoint getFlightPoint(size_t /*flight*/, seconds_f timestamp, PlaybackCursor &cursor) {
+            return getPoint(timestamp, cursor);
+        }
+
+        /**
+         * @brief Returns the path of one of the flights, in the frame and timeline of getPoint().
+         * @param flight The index of the flight, flight 0 is the one returned by getPoint().
+         * @details Only available once the load is complete, like getPath().
+         */
+        virtual std::span<const FlightDataPoint> getFlightPath(size_t /*flight*/) {
+            return getPath();
+        }
+
+        /**
+         * @brief Returns how far one of the flights strays from flight 0 where flight 0 is at the given timestamp, in meters.
+         * @details Flights are matched along their paths rather than by time, so that the same route flown at a different
+         * pace doesn't deviate. Sources that don't compare their flights return nothing.
+         */
+        virtual std::optional<float> getFlightDeviation(size_t /*flight*/, seconds_f /*timestamp*/) {
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Returns every column of the source log, for plotting values that are not part of the flight data points.
+         * @details Rows are on the same timeline as getPoint(). Sources without a tabular log return null, as do sources
+         * still loading.
+         */
+        virtual TelemetryStore *getTelemetry() {
+            return nullptr;
+        }
+
+        /**
+         * @brief Returns the samples of the flight as a track, with their derived channels.
+         * @details Sources that don't keep a track return null, as do sources still loading. Their channels are still
+         * available from getChannels() and their samples from decodePath().
+         */
+        virtual const FlightTrack *getTrack() {
+            return nullptr;
+        }
+
+        /**
+         * @brief Returns the anomalies detected in the flight, sorted by start time.
+         * @details Sources that don't scan for anomalies return none, as do sources still loading.
+         */
+        virtual std::span<const FlightAnomaly> getAnomalies() {
+            return {};
+        }
+
         virtual float getMaximumAltitude() = 0;
         virtual float getMinimumAltitude() = 0;
 
@@ -58,6 +247,23 @@ namespace dfv {
         virtual seconds_f getEndTime() = 0;
 
         virtual FlightBoundingBox getBoundingBox() = 0;
-        virtual std::vector<FlightDataPoint> &getPath() = 0;
+        virtual const std::vector<FlightDataPoint> &getPath() = 0;
+
+        /**
+         * @brief Returns every sample of the flight, for sources whose getPath() is already simplified.
+         * @details The samples are decoded or copied, so this is meant for one-off uses such as building an index.
+         */
+        virtual std::vector<FlightDataPoint> decodePath() {
+            return getPath();
+        }
+
+        /**
+         * @brief Returns a simplified version of the path, for drawing it when the full detail would not be visible.
+         * @param maxError The maximum distance in meters any sample of the path may be from the returned one.
+         * @details The error for a given camera can be obtained with PathHierarchy::screenToWorldError().
+         */
+        virtual std::span<const FlightDataPoint> getSimplifiedPath(float /*maxError*/) {
+            return getPath();
+        }
     };
 } // namespace dfv
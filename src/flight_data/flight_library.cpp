@@ -0,0 +1,536 @@
+#include "flight_library.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <utils/temp_path.h>
+#include <utils/time_types.h>
+
+#include "csv_tokenizer.h"
+#include "dji_csv_parser.h"
+#include "flight_cache.h"
+
+namespace dfv {
+    namespace {
+        using namespace csv_tokenizer;
+
+        constexpr size_t Dimensions = 3; //!< Latitude, longitude and time
+
+        /**
+         * @brief The columns read from each log, used as indices into the column tables.
+         */
+        enum Column : uint8_t {
+            Latitude,
+            Longitude,
+            FlyTime,
+            Date, //!< The local date of the row, as M/D/YYYY
+            TimeOfDay, //!< The local time of the row, as h:mm:ss.ss AM/PM
+            ColumnCount,
+        };
+
+        // Must match the order of Column
+        constexpr std::array<std::string_view, ColumnCount> ColumnNames = {
+                DjiCsvParser::LatitudeColumn,
+                DjiCsvParser::LongitudeColumn,
+                DjiCsvParser::TimeColumn,
+                "CUSTOM.date [local]",
+                "CUSTOM.updateTime [local]",
+        };
+        constexpr size_t RequiredColumns = 3; //!< The columns before this one must be present
+
+        struct ScanRow {
+            double lat;
+            double lon;
+            float flyTime;
+            std::string_view date;
+            std::string_view timeOfDay;
+        };
+
+        /**
+         * @brief Maps each column of the header up to the last one read to its Column, -1 for the others.
+         * @note Throws std::runtime_error if any of the required columns is missing.
+         */
+        std::vector<int8_t> resolveColumns(std::string_view header) {
+            std::array<int, ColumnCount> columns;
+            columns.fill(-1);
+
+            const char *p = header.data();
+            const char *end = header.data() + header.size();
+            for (int column = 0; p <= end; column++) {
+                const auto name = trim(nextField(p, end));
+                const auto it = std::find(ColumnNames.begin(), ColumnNames.end(), name);
+                if (it != ColumnNames.end() && columns[it - ColumnNames.begin()] < 0)
+                    columns[it - ColumnNames.begin()] = column;
+
+                if (p >= end)
+                    break;
+                p++; // Skip the delimiter
+            }
+
+            for (size_t column = 0; column < RequiredColumns; column++) {
+                if (columns[column] < 0)
+                    throw std::runtime_error("Flight data is missing the required column " + std::string{ColumnNames[column]});
+            }
+
+            std::vector<int8_t> slots(*std::max_element(columns.begin(), columns.end()) + 1, -1);
+            for (size_t column = 0; column < ColumnCount; column++) {
+                if (columns[column] >= 0)
+                    slots[columns[column]] = static_cast<int8_t>(column);
+            }
+            return slots;
+        }
+
+        /**
+         * @brief Parses the row starting at cursor, tokenizing it only up to the last column read, and advances cursor
+         * to the start of the next row.
+         * @return True if the row held valid values for all the required columns, false otherwise.
+         */
+        bool scanRow(const char *&cursor, const char *end, const std::vector<int8_t> &slots, ScanRow &row) {
+            std::array<std::string_view, ColumnCount> fields{};
+
+            const char *p = cursor;
+            size_t column = 0;
+            for (; column < slots.size(); column++) {
+                const auto field = nextField(p, end);
+                if (slots[column] >= 0)
+                    fields[slots[column]] = field;
+
+                if (p >= end || *p == '\n')
+                    break;
+                p++; // Skip the delimiter
+            }
+
+            if (p < end && *p == '\n')
+                cursor = p + 1;
+            else
+                cursor = skipRow(p, end);
+
+            row.date = fields[Date];
+            row.timeOfDay = fields[TimeOfDay];
+            return parseNumber(fields[Latitude], row.lat) &&
+                   parseNumber(fields[Longitude], row.lon) &&
+                   parseNumber(fields[FlyTime], row.flyTime);
+        }
+
+        /**
+         * @brief Parses the next integer at p, which must be followed by the given separator or by the end of the text.
+         */
+        bool parseInteger(const char *&p, const char *end, int &value, const char separator) {
+            const auto [ptr, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc{} || (ptr != end && *ptr != separator))
+                return false;
+            p = ptr == end ? end : ptr + 1;
+            return true;
+        }
+
+        /**
+         * @brief Parses the local date and time of a row as DJI logs record them, "M/D/YYYY" and "h:mm:ss.ss AM".
+         * @details The time may also be in 24-hour format, without the AM/PM suffix.
+         * @return The time in seconds since the epoch, or an empty optional if either is malformed.
+         */
+        std::optional<int64_t> parseLocalTime(std::string_view date, std::string_view timeOfDay) {
+            date = trim(date);
+            timeOfDay = trim(timeOfDay);
+
+            int month, day, year;
+            const char *p = date.data();
+            const char *end = date.data() + date.size();
+            if (!parseInteger(p, end, month, '/') || !parseInteger(p, end, day, '/') || !parseInteger(p, end, year, '\0'))
+                return std::nullopt;
+
+            const std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{static_cast<unsigned int>(month)},
+                                                  std::chrono::day{static_cast<unsigned int>(day)}};
+            if (!ymd.ok())
+                return std::nullopt;
+
+            int hour, minute;
+            p = timeOfDay.data();
+            end = timeOfDay.data() + timeOfDay.size();
+            if (!parseInteger(p, end, hour, ':') || !parseInteger(p, end, minute, ':'))
+                return std::nullopt;
+
+            float second;
+            const auto [secondEnd, ec] = std::from_chars(p, end, second);
+            if (ec != std::errc{})
+                return std::nullopt;
+
+            const auto suffix = trim({secondEnd, end});
+            if (suffix == "PM" && hour < 12)
+                hour += 12;
+            else if (suffix == "AM" && hour == 12)
+                hour = 0;
+            else if (!suffix.empty() && suffix != "AM" && suffix != "PM")
+                return std::nullopt;
+
+            const auto days = std::chrono::sys_days{ymd}.time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::seconds>(days).count() + hour * 3600 + minute * 60 +
+                   static_cast<int64_t>(second);
+        }
+
+        FlightLibrary::Box toBox(const LibraryFlight &flight) {
+            return {.minLat = flight.boundingBox.llLat,
+                    .minLon = flight.boundingBox.llLon,
+                    .maxLat = flight.boundingBox.urLat,
+                    .maxLon = flight.boundingBox.urLon,
+                    .startTime = flight.startTime,
+                    .endTime = flight.startTime + static_cast<int64_t>(std::ceil(flight.duration))};
+        }
+
+        FlightLibrary::Box merge(const FlightLibrary::Box &a, const FlightLibrary::Box &b) {
+            return {.minLat = std::min(a.minLat, b.minLat),
+                    .minLon = std::min(a.minLon, b.minLon),
+                    .maxLat = std::max(a.maxLat, b.maxLat),
+                    .maxLon = std::max(a.maxLon, b.maxLon),
+                    .startTime = std::min(a.startTime, b.startTime),
+                    .endTime = std::max(a.endTime, b.endTime)};
+        }
+
+        bool intersects(const FlightLibrary::Box &a, const FlightLibrary::Box &b) {
+            return a.minLat <= b.maxLat && a.maxLat >= b.minLat &&
+                   a.minLon <= b.maxLon && a.maxLon >= b.minLon &&
+                   a.startTime <= b.endTime && a.endTime >= b.startTime;
+        }
+
+        double center(const FlightLibrary::Box &box, const size_t dimension) {
+            switch (dimension) {
+                case 0:
+                    return (box.minLat + box.maxLat) / 2.0;
+                case 1:
+                    return (box.minLon + box.maxLon) / 2.0;
+                default:
+                    return (static_cast<double>(box.startTime) + static_cast<double>(box.endTime)) / 2.0;
+            }
+        }
+
+        /**
+         * @brief A box to be packed in a node, along with the index of what it bounds.
+         */
+        struct Entry {
+            FlightLibrary::Box box;
+            uint32_t index;
+        };
+
+        /**
+         * @brief Orders the entries so that every run of NodeCapacity entries makes a compact node.
+         * @details The entries are sorted along the given dimension and cut in slabs, each of which is sorted along the
+         * next dimension and cut again, until the last dimension. The slab count is chosen so that the nodes end up in
+         * a grid with about as many nodes along each dimension.
+         */
+        void sortTileRecursive(std::span<Entry> entries, const size_t dimension) {
+            std::sort(entries.begin(), entries.end(), [dimension](const Entry &a, const Entry &b) {
+                return center(a.box, dimension) < center(b.box, dimension);
+            });
+            if (dimension + 1 == Dimensions || entries.size() <= FlightLibrary::NodeCapacity)
+                return;
+
+            const size_t nodeCount = (entries.size() + FlightLibrary::NodeCapacity - 1) / FlightLibrary::NodeCapacity;
+            const auto slabCount = static_cast<size_t>(
+                    std::ceil(std::pow(static_cast<double>(nodeCount), 1.0 / static_cast<double>(Dimensions - dimension))));
+            const size_t slabSize = FlightLibrary::NodeCapacity * ((nodeCount + slabCount - 1) / slabCount);
+            for (size_t begin = 0; begin < entries.size(); begin += slabSize)
+                sortTileRecursive(entries.subspan(begin, std::min(slabSize, entries.size() - begin)), dimension + 1);
+        }
+
+        /**
+         * @brief Packs runs of NodeCapacity children into nodes.
+         * @param children The boxes of the children, stored contiguously starting at index first.
+         */
+        template<typename Child>
+        std::vector<FlightLibrary::Node> packNodes(std::span<const Child> children, const size_t first, const bool leaf) {
+            std::vector<FlightLibrary::Node> nodes;
+            nodes.reserve((children.size() + FlightLibrary::NodeCapacity - 1) / FlightLibrary::NodeCapacity);
+            for (size_t begin = 0; begin < children.size(); begin += FlightLibrary::NodeCapacity) {
+                const size_t count = std::min<size_t>(FlightLibrary::NodeCapacity, children.size() - begin);
+                FlightLibrary::Box box = children[begin].box;
+                for (size_t i = begin + 1; i < begin + count; i++)
+                    box = merge(box, children[i].box);
+
+                nodes.push_back({.box = box,
+                                 .first = static_cast<uint32_t>(first + begin),
+                                 .count = static_cast<uint32_t>(count),
+                                 .leaf = leaf,
+                                 .padding = 0});
+            }
+            return nodes;
+        }
+    } // namespace
+
+    static_assert(std::is_trivially_copyable_v<FlightLibrary::Header>, "The index is written as raw bytes");
+    static_assert(sizeof(FlightLibrary::Header) % alignof(FlightLibrary::Node) == 0 &&
+                          sizeof(FlightLibrary::Node) % alignof(FlightLibrary::Flight) == 0,
+                  "The index is read in place, every array must be aligned");
+
+    LibraryFlight scanFlightLog(const std::filesystem::path &path) {
+        const MappedFile file{path};
+        const auto [header, body] = DjiCsvParser::splitHeader(file.data());
+        const auto slots = resolveColumns(header);
+
+        const char *cursor = body.data();
+        const char *end = body.data() + body.size();
+
+        ScanRow row{};
+        bool foundFirst = false;
+        while (!foundFirst) {
+            skipBlankLines(cursor, end);
+            if (cursor == end)
+                throw std::runtime_error("Flight data contains no valid rows");
+            foundFirst = scanRow(cursor, end, slots, row);
+        }
+
+        LibraryFlight flight{.path = path};
+        const auto startTime = parseLocalTime(row.date, row.timeOfDay);
+
+        if (const auto cache = FlightCache{path}.loadHeader()) {
+            flight.boundingBox = cache->boundingBox;
+            flight.duration = cache->endTimestamp - cache->startTimestamp;
+        } else {
+            FlightSummary summary{};
+            float firstTimestamp = row.flyTime;
+            float lastTimestamp = row.flyTime;
+            summary.extend({.lat = row.lat, .lon = row.lon, .alt = 0.0});
+
+            while (true) {
+                skipBlankLines(cursor, end);
+                if (cursor == end)
+                    break;
+                if (!scanRow(cursor, end, slots, row))
+                    continue;
+
+                summary.extend({.lat = row.lat, .lon = row.lon, .alt = 0.0});
+                firstTimestamp = std::min(firstTimestamp, row.flyTime);
+                lastTimestamp = std::max(lastTimestamp, row.flyTime);
+            }
+
+            flight.boundingBox = summary.boundingBox;
+            flight.duration = lastTimestamp - firstTimestamp;
+        }
+
+        if (startTime) {
+            flight.startTime = *startTime;
+        } else {
+            // The log was last written when the flight ended, at the latest
+            const auto modified = std::chrono::file_clock::to_sys(std::filesystem::last_write_time(path));
+            flight.startTime = std::chrono::duration_cast<std::chrono::seconds>(modified.time_since_epoch()).count() -
+                               static_cast<int64_t>(flight.duration);
+        }
+
+        return flight;
+    }
+
+    size_t FlightLibrary::build(const std::filesystem::path &directory, const std::filesystem::path &indexPath,
+                                unsigned int threadCount) {
+        const auto startTime = clock::now();
+
+        std::vector<std::filesystem::path> logs;
+        try {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator{directory}) {
+                auto extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+                if (entry.is_regular_file() && extension == ".csv")
+                    logs.push_back(entry.path());
+            }
+        } catch (const std::filesystem::filesystem_error &e) {
+            throw std::runtime_error("Failed to list flight logs: " + std::string{e.what()});
+        }
+        // Keep the index the same across runs over the same directory
+        std::sort(logs.begin(), logs.end());
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t workerCount = std::clamp<size_t>(logs.size(), 1, threadCount);
+
+        // Logs are handed out one at a time as their sizes vary wildly
+        std::vector<std::optional<LibraryFlight>> scanned(logs.size());
+        std::vector<std::string> errors(logs.size());
+        std::atomic<size_t> nextLog{0};
+        const auto work = [&] {
+            for (size_t i = nextLog++; i < logs.size(); i = nextLog++) {
+                try {
+                    scanned[i] = scanFlightLog(logs[i]);
+                } catch (const std::exception &e) {
+                    errors[i] = e.what();
+                }
+            }
+        };
+
+        std::vector<std::future<void>> workers;
+        workers.reserve(workerCount);
+        for (size_t worker = 0; worker < workerCount; worker++)
+            workers.push_back(std::async(std::launch::async, work));
+        for (auto &worker : workers)
+            worker.get();
+
+        std::vector<LibraryFlight> flights;
+        flights.reserve(logs.size());
+        for (size_t i = 0; i < logs.size(); i++) {
+            if (scanned[i])
+                flights.push_back(std::move(*scanned[i]));
+            else
+                std::cerr << "Skipping flight log " << logs[i] << ": " << errors[i] << std::endl;
+        }
+
+        const size_t flightCount = flights.size();
+        write(std::move(flights), indexPath);
+
+        std::cout << "Indexed " << flightCount << " flights in "
+                  << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms ("
+                  << logs.size() - flightCount << " skipped)" << std::endl;
+        return flightCount;
+    }
+
+    void FlightLibrary::write(std::vector<LibraryFlight> flights, const std::filesystem::path &indexPath) {
+        std::vector<Entry> entries(flights.size());
+        for (size_t i = 0; i < flights.size(); i++)
+            entries[i] = {.box = toBox(flights[i]), .index = static_cast<uint32_t>(i)};
+        sortTileRecursive(entries, 0);
+
+        // Flights are stored in the order of the leaves
+        const auto indexDirectory = std::filesystem::absolute(indexPath).parent_path();
+        std::vector<Flight> records;
+        records.reserve(flights.size());
+        std::string pathTable;
+        for (const auto &entry : entries) {
+            const auto &flight = flights[entry.index];
+            const auto relativePath = std::filesystem::absolute(flight.path).lexically_relative(indexDirectory).generic_u8string();
+            records.push_back({.box = entry.box,
+                               .pathOffset = pathTable.size(),
+                               .pathSize = static_cast<uint32_t>(relativePath.size()),
+                               .duration = flight.duration});
+            pathTable.append(reinterpret_cast<const char *>(relativePath.data()), relativePath.size());
+        }
+
+        // Each level is ordered like the flights before being stored, so that the nodes of each parent are contiguous
+        std::vector<Node> nodes;
+        auto level = packNodes<Flight>(records, 0, true);
+        while (level.size() > 1) {
+            std::vector<Entry> levelEntries(level.size());
+            for (size_t i = 0; i < level.size(); i++)
+                levelEntries[i] = {.box = level[i].box, .index = static_cast<uint32_t>(i)};
+            sortTileRecursive(levelEntries, 0);
+
+            const size_t first = nodes.size();
+            for (const auto &entry : levelEntries)
+                nodes.push_back(level[entry.index]);
+            level = packNodes<Node>(std::span{nodes}.subspan(first), first, false);
+        }
+        nodes.insert(nodes.end(), level.begin(), level.end());
+
+        const Header header{.magic = Magic,
+                            .version = Version,
+                            .nodeCapacity = NodeCapacity,
+                            .flightCount = records.size(),
+                            .nodeCount = nodes.size(),
+                            .pathSize = pathTable.size()};
+
+        // Write to a temporary file first so that readers never map a truncated index, nor concurrent writers mix theirs
+        const auto tempPath = uniqueTempPath(indexPath);
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+            file.write(reinterpret_cast<const char *>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(Node)));
+            file.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Flight)));
+            file.write(pathTable.data(), static_cast<std::streamsize>(pathTable.size()));
+            if (!file) {
+                file.close();
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                throw std::runtime_error("Failed to write flight library index " + indexPath.string());
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, indexPath, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            throw std::runtime_error("Failed to write flight library index " + indexPath.string() + ": " + ec.message());
+        }
+    }
+
+    FlightLibrary::FlightLibrary(const std::filesystem::path &indexPath)
+        : directory(std::filesystem::absolute(indexPath).parent_path()), file(indexPath) {
+        const auto data = file.data();
+        Header header{};
+        if (data.size() >= sizeof(Header))
+            std::memcpy(&header, data.data(), sizeof(Header));
+        if (header.magic != Magic || header.version != Version || header.nodeCapacity != NodeCapacity)
+            throw std::runtime_error("Not a flight library index of the current version: " + indexPath.string());
+
+        const size_t nodesOffset = sizeof(Header);
+        const size_t flightsOffset = nodesOffset + header.nodeCount * sizeof(Node);
+        const size_t pathsOffset = flightsOffset + header.flightCount * sizeof(Flight);
+        if (data.size() != pathsOffset + header.pathSize)
+            throw std::runtime_error("Flight library index is corrupted: " + indexPath.string());
+
+        // The mapping is page aligned and every array is aligned within the file
+        nodes = {reinterpret_cast<const Node *>(data.data() + nodesOffset), header.nodeCount};
+        flights = {reinterpret_cast<const Flight *>(data.data() + flightsOffset), header.flightCount};
+        paths = {data.data() + pathsOffset, header.pathSize};
+    }
+
+    size_t FlightLibrary::flightCount() const {
+        return flights.size();
+    }
+
+    std::vector<LibraryFlight> FlightLibrary::query(const LibraryQuery &query) const {
+        constexpr double Infinity = std::numeric_limits<double>::infinity();
+        const Box area = query.area ? Box{.minLat = query.area->llLat,
+                                          .minLon = query.area->llLon,
+                                          .maxLat = query.area->urLat,
+                                          .maxLon = query.area->urLon,
+                                          .startTime = query.from,
+                                          .endTime = query.to}
+                                    : Box{.minLat = -Infinity,
+                                          .minLon = -Infinity,
+                                          .maxLat = Infinity,
+                                          .maxLon = Infinity,
+                                          .startTime = query.from,
+                                          .endTime = query.to};
+
+        std::vector<LibraryFlight> matches;
+        if (nodes.empty())
+            return matches;
+
+        std::vector<uint32_t> pending{static_cast<uint32_t>(nodes.size() - 1)};
+        while (!pending.empty()) {
+            const Node &node = nodes[pending.back()];
+            pending.pop_back();
+            if (!intersects(node.box, area))
+                continue;
+
+            for (uint32_t child = node.first; child < node.first + node.count; child++) {
+                if (!node.leaf) {
+                    pending.push_back(child);
+                    continue;
+                }
+
+                const Flight &flight = flights[child];
+                if (!intersects(flight.box, area))
+                    continue;
+
+                const auto path = paths.substr(flight.pathOffset, flight.pathSize);
+                matches.push_back({.path = directory / std::u8string{path.begin(), path.end()},
+                                   .boundingBox = {.llLat = flight.box.minLat,
+                                                   .llLon = flight.box.minLon,
+                                                   .urLat = flight.box.maxLat,
+                                                   .urLon = flight.box.maxLon},
+                                   .startTime = flight.box.startTime,
+                                   .duration = flight.duration});
+            }
+        }
+
+        return matches;
+    }
+} // namespace dfv
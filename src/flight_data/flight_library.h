@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <utils/mapped_file.h>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief What a flight library knows about a flight log without loading it.
+     */
+    struct LibraryFlight {
+        std::filesystem::path path;
+        FlightBoundingBox boundingBox{};
+        int64_t startTime{0}; //!< When the flight started, in seconds since the epoch in the local time of the log
+        float duration{0.f}; //!< In seconds
+    };
+
+    /**
+     * @brief A query on a flight library, flights must match every criterion.
+     */
+    struct LibraryQuery {
+        std::optional<FlightBoundingBox> area; //!< Only flights whose bounding box intersects this area
+        int64_t from{std::numeric_limits<int64_t>::min()}; //!< Only flights still in the air at or after this time
+        int64_t to{std::numeric_limits<int64_t>::max()}; //!< Only flights that started at or before this time
+    };
+
+    /**
+     * @brief Reads the summary of a single flight log, reading as little of it as possible.
+     * @details The bounding box and duration come from the header of the binary flight cache when it is valid,
+     * otherwise every row is tokenized only up to its position and time columns. The start time comes from the date
+     * columns of the first valid row, or from the modification time of the file for logs that don't record the date.
+     * @note Throws std::runtime_error if the file cannot be read or contains no valid rows.
+     */
+    LibraryFlight scanFlightLog(const std::filesystem::path &path);
+
+    /**
+     * @brief An on-disk spatial index of a collection of flight logs.
+     * @details The index is an R-tree over the (latitude, longitude, time) box of every flight, bulk loaded with the
+     * Sort-Tile-Recursive algorithm so that every node but the last of each level is full. Nodes, flights and paths are
+     * laid out as flat arrays that are memory mapped and queried in place, without deserializing anything.
+     *
+     * Paths are stored relative to the directory of the index, so a library can be moved along with its logs.
+     */
+    class FlightLibrary {
+      public:
+        static constexpr std::array<char, 8> Magic = {'D', 'F', 'V', 'I', 'D', 'X', '\0', '\0'};
+        static constexpr uint32_t Version = 1; //!< Must be bumped whenever the layout of the file changes
+        static constexpr uint32_t NodeCapacity = 16; //!< The maximum number of children of a node
+
+        /**
+         * @brief Scans every CSV flight log in a directory and its subdirectories and writes the index of those that
+         * could be read.
+         * @param threadCount The number of logs scanned at once, 0 to use all hardware threads.
+         * @return The number of flights indexed.
+         * @note Throws std::runtime_error if the directory cannot be listed or the index cannot be written.
+         */
+        static size_t build(const std::filesystem::path &directory, const std::filesystem::path &indexPath,
+                            unsigned int threadCount = 0);
+
+        /**
+         * @brief Maps the index at the given path.
+         * @note Throws std::runtime_error if the index is missing, corrupted or of another version.
+         */
+        explicit FlightLibrary(const std::filesystem::path &indexPath);
+
+        size_t flightCount() const;
+
+        /**
+         * @return The flights matching the query, in no particular order.
+         */
+        std::vector<LibraryFlight> query(const LibraryQuery &query) const;
+
+        /**
+         * @brief A box in latitude, longitude and time.
+         */
+        struct Box {
+            double minLat;
+            double minLon;
+            double maxLat;
+            double maxLon;
+            int64_t startTime; //!< In seconds since the epoch
+            int64_t endTime; //!< In seconds since the epoch
+        };
+
+        /**
+         * @brief The header at the start of an index file, followed by the nodes, the flights and the path table.
+         */
+        struct Header {
+            std::array<char, 8> magic;
+            uint32_t version;
+            uint32_t nodeCapacity;
+            uint64_t flightCount;
+            uint64_t nodeCount;
+            uint64_t pathSize; //!< The size of the path table in bytes
+        };
+
+        struct Node {
+            Box box; //!< Bounds the boxes of every child
+            uint32_t first; //!< The index of the first child, in flights for leaves and in nodes otherwise
+            uint32_t count; //!< The number of children, which are contiguous
+            uint32_t leaf; //!< Whether the children are flights
+            uint32_t padding;
+        };
+
+        struct Flight {
+            Box box;
+            uint64_t pathOffset; //!< The offset of the path in the path table, relative to the index directory
+            uint32_t pathSize;
+            float duration; //!< In seconds
+        };
+
+      private:
+        /**
+         * @brief Writes the index of the given flights, ordering them so that each leaf holds contiguous flights.
+         */
+        static void write(std::vector<LibraryFlight> flights, const std::filesystem::path &indexPath);
+
+        const std::filesystem::path directory; //!< The directory paths are relative to
+        const MappedFile file;
+        std::span<const Node> nodes; //!< Every level of the tree from the leaves up, the root is the last node
+        std::span<const Flight> flights;
+        std::string_view paths;
+    };
+} // namespace dfv
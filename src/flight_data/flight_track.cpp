@@ -0,0 +1,469 @@
+#include "flight_track.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "interpolation.h"
+
+namespace dfv {
+    namespace {
+        constexpr size_t BatchSize = 256; //!< The number of timestamps interpolated per pass of the kernels
+        constexpr size_t MaxCursorWalk = 8; //!< The number of segments a cursor walks before falling back to the index
+        constexpr size_t SamplesPerBucket = 4; //!< The average number of samples covered by each time bucket
+
+        // The kernels below are kept as plain loops over contiguous arrays with no branches in their bodies,
+        // so that they are auto-vectorized (AVX2 on x86-64, NEON on ARM) without platform-specific code
+
+        /**
+         * @brief Gathers the samples at the start and end of each segment into contiguous arrays.
+         */
+        void gatherKernel(const float *column, const uint32_t *segments, float *starts, float *ends, const size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                starts[i] = column[segments[i]];
+                ends[i] = column[segments[i] + 1];
+            }
+        }
+
+        void lerpKernel(const float *starts, const float *ends, const float *factors, float *out, const size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = lerp(starts[i], ends[i], factors[i]);
+        }
+
+        void lerpAngleKernel(const float *starts, const float *ends, const float *factors, float *out, const size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = lerpAngle(starts[i], ends[i], factors[i]);
+        }
+
+        // The rates are split across kernels with few arrays each, as the compiler gives up on vectorizing loops that
+        // need too many runtime checks for overlapping arrays
+
+        /**
+         * @brief Computes the ground speed and the 3D step length between each sample in [first, last) and the one before it.
+         * @param scale The length of the horizontal units, the altitude being in meters already.
+         * @note first must be at least 1.
+         */
+        void speedKernel(const float *timestamp, const float *x, const float *y, const float *z, float *groundSpeed,
+                         float *steps, const UnitScale scale, const size_t first, const size_t last) {
+            for (size_t i = first; i < last; i++) {
+                const float horizontal = horizontalDistance(x[i] - x[i - 1], z[i] - z[i - 1], scale);
+                const float dy = y[i] - y[i - 1];
+                groundSpeed[i] = horizontal * safeReciprocal(timestamp[i] - timestamp[i - 1]);
+                steps[i] = std::sqrt(horizontal * horizontal + dy * dy);
+            }
+        }
+
+        /**
+         * @brief Computes the rate of change of the values between each sample in [first, last) and the one before it.
+         * @param angular Whether the values are angles, whose differences are wrapped to [-pi, pi].
+         * @note first must be at least 1.
+         */
+        void derivativeKernel(const float *timestamp, const float *values, float *out, const size_t first, const size_t last,
+                              const bool angular) {
+            const float wrap = angular ? 1.f : 0.f;
+            for (size_t i = first; i < last; i++) {
+                float diff = values[i] - values[i - 1];
+                diff -= wrap * TwoPi * std::nearbyint(diff * InvTwoPi);
+                out[i] = diff * safeReciprocal(timestamp[i] - timestamp[i - 1]);
+            }
+        }
+
+        /**
+         * @brief Computes the rate of change of the 3D speed between each sample in [first, last) and the one before it.
+         * @note first must be at least 1.
+         */
+        void accelerationKernel(const float *timestamp, const float *groundSpeed, const float *verticalSpeed,
+                                float *acceleration, const size_t first, const size_t last) {
+            for (size_t i = first; i < last; i++) {
+                const float invDt = safeReciprocal(timestamp[i] - timestamp[i - 1]);
+
+                const float speed = std::sqrt(groundSpeed[i] * groundSpeed[i] + verticalSpeed[i] * verticalSpeed[i]);
+                const float previousSpeed = std::sqrt(groundSpeed[i - 1] * groundSpeed[i - 1] +
+                                                      verticalSpeed[i - 1] * verticalSpeed[i - 1]);
+                acceleration[i] = (speed - previousSpeed) * invDt;
+            }
+        }
+    } // namespace
+
+    FlightTrack::FlightTrack(std::span<const FlightDataPoint> points, const double originLatitude)
+        : FlightTrack{points.size(), originLatitude} {
+        append(points);
+        finalize();
+    }
+
+    FlightTrack::FlightTrack(const size_t capacity, const double originLatitude) : unitScale(unitScaleAt(originLatitude)) {
+        for (auto *column : {&timestamp, &x, &y, &z, &yaw, &pitch, &roll,
+                             &groundSpeed, &verticalSpeed, &acceleration, &distance, &headingRate})
+            column->resize(capacity);
+    }
+
+    FlightTrack::FlightTrack(const FlightTrack &other, const size_t capacity) : FlightTrack{capacity, 0.0} {
+        unitScale = other.unitScale;
+
+        const size_t count = std::min(other.size(), capacity);
+        const auto copyPrefix = [count](const std::vector<float> &from, std::vector<float> &to) {
+            std::copy_n(from.begin(), count, to.begin());
+        };
+        copyPrefix(other.timestamp, timestamp);
+        copyPrefix(other.x, x);
+        copyPrefix(other.y, y);
+        copyPrefix(other.z, z);
+        copyPrefix(other.yaw, yaw);
+        copyPrefix(other.pitch, pitch);
+        copyPrefix(other.roll, roll);
+        copyPrefix(other.groundSpeed, groundSpeed);
+        copyPrefix(other.verticalSpeed, verticalSpeed);
+        copyPrefix(other.acceleration, acceleration);
+        copyPrefix(other.distance, distance);
+        copyPrefix(other.headingRate, headingRate);
+        sampleCount.store(count, std::memory_order_release);
+    }
+
+    FlightTrack::FlightTrack(FlightTrack &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    FlightTrack &FlightTrack::operator=(FlightTrack &&other) noexcept {
+        timestamp = std::move(other.timestamp);
+        x = std::move(other.x);
+        y = std::move(other.y);
+        z = std::move(other.z);
+        yaw = std::move(other.yaw);
+        pitch = std::move(other.pitch);
+        roll = std::move(other.roll);
+        groundSpeed = std::move(other.groundSpeed);
+        verticalSpeed = std::move(other.verticalSpeed);
+        acceleration = std::move(other.acceleration);
+        distance = std::move(other.distance);
+        headingRate = std::move(other.headingRate);
+        unitScale = other.unitScale;
+        bucketSegments = std::move(other.bucketSegments);
+        bucketOrigin = other.bucketOrigin;
+        bucketScale = other.bucketScale;
+        sampleCount.store(other.sampleCount.exchange(0));
+        indexed.store(other.indexed.exchange(false));
+        return *this;
+    }
+
+    size_t FlightTrack::append(std::span<const FlightDataPoint> points) {
+        // The writer is the only thread changing the count, so it can read it without synchronization
+        const size_t start = sampleCount.load(std::memory_order_relaxed);
+        const size_t count = std::min(points.size(), timestamp.size() - start);
+
+        for (size_t i = 0; i < count; i++) {
+            const auto &point = points[i];
+            timestamp[start + i] = point.timestamp;
+            x[start + i] = point.x;
+            y[start + i] = point.y;
+            z[start + i] = point.z;
+            yaw[start + i] = point.yaw;
+            pitch[start + i] = point.pitch;
+            roll[start + i] = point.roll;
+        }
+        deriveChannels(start, start + count);
+
+        sampleCount.store(start + count, std::memory_order_release);
+        return count;
+    }
+
+    void FlightTrack::deriveChannels(const size_t begin, const size_t end) {
+        if (begin == end)
+            return;
+
+        // The first sample has nothing to derive from
+        if (begin == 0) {
+            for (auto *column : {&groundSpeed, &verticalSpeed, &acceleration, &distance, &headingRate})
+                (*column)[0] = 0.f;
+        }
+        const size_t first = std::max<size_t>(begin, 1);
+
+        // The distance column first receives the length of each step, then it is accumulated
+        speedKernel(timestamp.data(), x.data(), y.data(), z.data(), groundSpeed.data(), distance.data(), unitScale,
+                    first, end);
+        derivativeKernel(timestamp.data(), y.data(), verticalSpeed.data(), first, end, false);
+        derivativeKernel(timestamp.data(), yaw.data(), headingRate.data(), first, end, true);
+        accelerationKernel(timestamp.data(), groundSpeed.data(), verticalSpeed.data(), acceleration.data(), first, end);
+        for (size_t i = first; i < end; i++)
+            distance[i] += distance[i - 1];
+    }
+
+    void FlightTrack::finalize() {
+        buildBucketIndex();
+        indexed.store(true, std::memory_order_release);
+    }
+
+    void FlightTrack::buildBucketIndex() {
+        const size_t count = sampleCount.load(std::memory_order_relaxed);
+        if (count < 2 || !(timestamp[count - 1] > timestamp.front()))
+            return;
+
+        const size_t bucketCount = std::max<size_t>(1, count / SamplesPerBucket);
+        bucketOrigin = timestamp.front();
+        bucketScale = static_cast<float>(bucketCount) / (timestamp[count - 1] - timestamp.front());
+
+        // A single sweep assigns every bucket start the segment containing it, the extra bucket closes the last range
+        bucketSegments.resize(bucketCount + 1);
+        const size_t lastSegment = count - 2;
+        size_t segment = 0;
+        for (size_t bucket = 0; bucket <= bucketCount; bucket++) {
+            const float bucketStart = bucketOrigin + static_cast<float>(bucket) / bucketScale;
+            while (segment < lastSegment && timestamp[segment + 1] <= bucketStart)
+                segment++;
+            bucketSegments[bucket] = static_cast<uint32_t>(segment);
+        }
+    }
+
+    size_t FlightTrack::size() const {
+        return sampleCount.load(std::memory_order_acquire);
+    }
+
+    bool FlightTrack::empty() const {
+        return size() == 0;
+    }
+
+    std::span<const float> FlightTrack::timestamps() const {
+        return {timestamp.data(), size()};
+    }
+
+    std::span<const float> FlightTrack::distances() const {
+        return {distance.data(), size()};
+    }
+
+    std::span<const float> FlightTrack::groundSpeeds() const {
+        return {groundSpeed.data(), size()};
+    }
+
+    std::span<const float> FlightTrack::verticalSpeeds() const {
+        return {verticalSpeed.data(), size()};
+    }
+
+    size_t FlightTrack::findSegment(const float time) const {
+        return findSegment(time, size());
+    }
+
+    size_t FlightTrack::findSegment(const float time, PlaybackCursor &cursor) const {
+        return findSegment(time, size(), cursor);
+    }
+
+    size_t FlightTrack::findSegment(const float time, const size_t count) const {
+        if (count < 2)
+            return 0;
+
+        const size_t lastSegment = count - 2;
+        if (!(time > timestamp.front()))
+            return 0;
+        if (time >= timestamp[count - 1])
+            return lastSegment;
+
+        // upper_bound returns the first sample after the timestamp, the segment starts at the one before it
+        const auto search = [&](const size_t first, const size_t last) {
+            const auto next = std::upper_bound(timestamp.begin() + first, timestamp.begin() + last, time);
+            return std::min(static_cast<size_t>(next - timestamp.begin()) - 1, lastSegment);
+        };
+
+        // The index only exists once the track is complete, until then the published prefix is searched as a whole
+        if (indexed.load(std::memory_order_acquire) && !bucketSegments.empty()) {
+            // The bucket bounds the search to the few segments overlapping it
+            const auto bucket = std::min(static_cast<size_t>((time - bucketOrigin) * bucketScale), bucketSegments.size() - 2);
+            const size_t segment = search(bucketSegments[bucket] + 1, std::min<size_t>(bucketSegments[bucket + 1] + 2, count - 1));
+
+            // Rounding may put timestamps close to a bucket edge in the neighbouring bucket
+            if (timestamp[segment] <= time && (time < timestamp[segment + 1] || segment == lastSegment))
+                return segment;
+        }
+
+        return search(1, count - 1);
+    }
+
+    size_t FlightTrack::findSegment(const float time, const size_t count, PlaybackCursor &cursor) const {
+        if (count < 2)
+            return cursor.segment = 0;
+
+        const size_t lastSegment = count - 2;
+        size_t segment = std::min(cursor.segment, lastSegment);
+
+        // Walk from the last segment, playback rarely moves more than one segment per frame
+        for (size_t step = 0; step < MaxCursorWalk; step++) {
+            if (time < timestamp[segment]) {
+                if (segment == 0)
+                    return cursor.segment = 0;
+                segment--;
+            } else if (time >= timestamp[segment + 1]) {
+                if (segment == lastSegment)
+                    return cursor.segment = lastSegment;
+                segment++;
+            } else {
+                return cursor.segment = segment;
+            }
+        }
+
+        // The timestamp is far away, seek with the index instead
+        return cursor.segment = findSegment(time, count);
+    }
+
+    FlightDataPoint FlightTrack::interpolate(const float time) const {
+        const size_t count = size();
+        return interpolateSegment(findSegment(time, count), time, count);
+    }
+
+    FlightDataPoint FlightTrack::interpolate(const float time, PlaybackCursor &cursor) const {
+        const size_t count = size();
+        return interpolateSegment(findSegment(time, count, cursor), time, count);
+    }
+
+    FlightDataPoint FlightTrack::interpolateSegment(const size_t segment, const float time, const size_t count) const {
+        if (count < 2) {
+            return count == 0 ? FlightDataPoint{time, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f}
+                              : FlightDataPoint{time, x[0], y[0], z[0], yaw[0], pitch[0], roll[0]};
+        }
+
+        const size_t next = segment + 1;
+        const float span = timestamp[next] - timestamp[segment];
+        const float t = span > 0.f ? std::clamp((time - timestamp[segment]) / span, 0.f, 1.f) : 0.f;
+
+        return {.timestamp = time,
+                .x = lerp(x[segment], x[next], t),
+                .y = lerp(y[segment], y[next], t),
+                .z = lerp(z[segment], z[next], t),
+                .yaw = lerpAngle(yaw[segment], yaw[next], t),
+                .pitch = lerpAngle(pitch[segment], pitch[next], t),
+                .roll = lerpAngle(roll[segment], roll[next], t)};
+    }
+
+    DerivedChannels FlightTrack::interpolateChannels(const float time, PlaybackCursor &cursor) const {
+        const size_t count = size();
+        if (count < 2)
+            return {};
+
+        const size_t segment = findSegment(time, count, cursor);
+        const size_t next = segment + 1;
+        const float span = timestamp[next] - timestamp[segment];
+        const float t = span > 0.f ? std::clamp((time - timestamp[segment]) / span, 0.f, 1.f) : 0.f;
+
+        return {.groundSpeed = lerp(groundSpeed[segment], groundSpeed[next], t),
+                .verticalSpeed = lerp(verticalSpeed[segment], verticalSpeed[next], t),
+                .acceleration = lerp(acceleration[segment], acceleration[next], t),
+                .distance = lerp(distance[segment], distance[next], t),
+                .headingRate = lerp(headingRate[segment], headingRate[next], t)};
+    }
+
+    FlightPose FlightTrack::interpolatePose(const float time, PlaybackCursor &cursor) const {
+        const size_t count = size();
+        const size_t segment = findSegment(time, count, cursor);
+
+        // The spline of a segment needs the sample after it, so until the track is finalized the last segment is linear
+        const size_t splineCount = indexed.load(std::memory_order_acquire) ? count - 1 : (count >= 2 ? count - 2 : 0);
+        if (count < 2 || segment >= splineCount) {
+            const auto point = interpolateSegment(segment, time, count);
+            const auto q = attitudeQuaternion(point.yaw, point.pitch, point.roll);
+            return {.x = point.x, .y = point.y, .z = point.z, .qw = q[0], .qx = q[1], .qy = q[2], .qz = q[3]};
+        }
+
+        const size_t next = segment + 1;
+        const float duration = timestamp[next] - timestamp[segment];
+        const float u = duration > 0.f ? std::clamp((time - timestamp[segment]) / duration, 0.f, 1.f) : 0.f;
+
+        // Cubic Hermite basis in normalized time with Catmull-Rom tangents, the tangent at a sample being the slope
+        // between its neighbours scaled to the duration of the segment. Missing neighbours at either end of the track are
+        // replaced by the closest sample.
+        const auto tangent = [&](const std::vector<float> &values, const size_t sample) {
+            const size_t previous = sample > 0 ? sample - 1 : 0;
+            const size_t following = std::min(sample + 1, count - 1);
+            const float span = timestamp[following] - timestamp[previous];
+            return span > 0.f ? (values[following] - values[previous]) / span : 0.f;
+        };
+        const auto cubic = [&](const std::vector<float> &values) {
+            const float p0 = values[segment];
+            const float p1 = values[next];
+            const float m0 = tangent(values, segment) * duration;
+            const float m1 = tangent(values, next) * duration;
+            return (((2.f * (p0 - p1) + m0 + m1) * u + 3.f * (p1 - p0) - 2.f * m0 - m1) * u + m0) * u + p0;
+        };
+
+        // Attitudes are slerped, taking whichever of q and -q is closest to the start to rotate the short way around
+        const auto start = attitudeQuaternion(yaw[segment], pitch[segment], roll[segment]);
+        auto end = attitudeQuaternion(yaw[next], pitch[next], roll[next]);
+        float dot = 0.f;
+        for (size_t i = 0; i < 4; i++)
+            dot += start[i] * end[i];
+        if (dot < 0.f) {
+            dot = -dot;
+            for (auto &component : end)
+                component = -component;
+        }
+
+        float startWeight = 1.f - u;
+        float endWeight = u;
+        const float angle = std::acos(std::min(dot, 1.f));
+        if (angle > 1e-4f) {
+            // The quaternions are lerped when the angle is too small for a slerp
+            const float inverseSinAngle = 1.f / std::sin(angle);
+            startWeight = std::sin(startWeight * angle) * inverseSinAngle;
+            endWeight = std::sin(endWeight * angle) * inverseSinAngle;
+        }
+        std::array<float, 4> q;
+        for (size_t i = 0; i < 4; i++)
+            q[i] = start[i] * startWeight + end[i] * endWeight;
+
+        return {.x = cubic(x), .y = cubic(y), .z = cubic(z), .qw = q[0], .qx = q[1], .qy = q[2], .qz = q[3]};
+    }
+
+    void FlightTrack::interpolate(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) const {
+        // Tracks with less than two samples have no segments to interpolate
+        const size_t count = size();
+        if (count < 2) {
+            const FlightDataPoint sample = count == 0 ? FlightDataPoint{}
+                                                      : FlightDataPoint{0.f, x[0], y[0], z[0], yaw[0], pitch[0], roll[0]};
+            for (size_t i = 0; i < timestamps.size(); i++) {
+                points[i] = sample;
+                points[i].timestamp = timestamps[i].count();
+            }
+            return;
+        }
+
+        PlaybackCursor cursor{};
+        std::array<float, BatchSize> batchTimes;
+        std::array<uint32_t, BatchSize> segments;
+        std::array<float, BatchSize> factors;
+        std::array<float, BatchSize> starts;
+        std::array<float, BatchSize> ends;
+        std::array<std::array<float, BatchSize>, 6> fields;
+
+        for (size_t batchStart = 0; batchStart < timestamps.size(); batchStart += BatchSize) {
+            const size_t batchCount = std::min(BatchSize, timestamps.size() - batchStart);
+            for (size_t i = 0; i < batchCount; i++)
+                batchTimes[i] = timestamps[batchStart + i].count();
+
+            // Locate the segment of every timestamp and the interpolation factor within it
+            for (size_t i = 0; i < batchCount; i++) {
+                const size_t segment = findSegment(batchTimes[i], count, cursor);
+                segments[i] = static_cast<uint32_t>(segment);
+
+                const float span = timestamp[segment + 1] - timestamp[segment];
+                factors[i] = span > 0.f ? std::clamp((batchTimes[i] - timestamp[segment]) / span, 0.f, 1.f) : 0.f;
+            }
+
+            const std::array<const std::vector<float> *, 6> columns = {&x, &y, &z, &yaw, &pitch, &roll};
+            for (size_t field = 0; field < columns.size(); field++) {
+                gatherKernel(columns[field]->data(), segments.data(), starts.data(), ends.data(), batchCount);
+
+                // The first three fields are positions, the rest are angles
+                if (field < 3)
+                    lerpKernel(starts.data(), ends.data(), factors.data(), fields[field].data(), batchCount);
+                else
+                    lerpAngleKernel(starts.data(), ends.data(), factors.data(), fields[field].data(), batchCount);
+            }
+
+            for (size_t i = 0; i < batchCount; i++) {
+                points[batchStart + i] = {.timestamp = batchTimes[i],
+                                          .x = fields[0][i],
+                                          .y = fields[1][i],
+                                          .z = fields[2][i],
+                                          .yaw = fields[3][i],
+                                          .pitch = fields[4][i],
+                                          .roll = fields[5][i]};
+            }
+        }
+    }
+} // namespace dfv
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief Structure-of-arrays storage of a flight path, used to interpolate it efficiently.
+     * @details Every field of FlightDataPoint is stored in its own contiguous array, so that interpolating many
+     * timestamps at once runs as straight loops over each field that the compiler can vectorize.
+     *
+     * A track can also be filled progressively: storage for all the samples is allocated upfront and a single writer
+     * appends to it while any number of readers interpolate the prefix that has been published so far.
+     */
+    class FlightTrack {
+      public:
+        FlightTrack() = default;
+
+        /**
+         * @brief Constructs a track from points sorted by timestamp.
+         * @param originLatitude The latitude the points are relative to, which sets the length of their east units.
+         */
+        FlightTrack(std::span<const FlightDataPoint> points, double originLatitude);
+
+        /**
+         * @brief Constructs an empty track that can be filled progressively with up to capacity samples.
+         * @param originLatitude The latitude the points are relative to, which sets the length of their east units.
+         */
+        FlightTrack(size_t capacity, double originLatitude);
+
+        /**
+         * @brief Constructs a track with room for capacity samples, starting with the published samples of another.
+         * @details Used to grow a track that ran out of capacity, without deriving its samples again. The other track may
+         * still be read concurrently, but not appended to.
+         */
+        FlightTrack(const FlightTrack &other, size_t capacity);
+
+        /**
+         * @note Must not be used while samples are being appended to the other track.
+         */
+        FlightTrack(FlightTrack &&other) noexcept;
+        FlightTrack &operator=(FlightTrack &&other) noexcept;
+
+        /**
+         * @brief Appends points sorted by timestamp to the end of the track and publishes them to readers.
+         * @details Only one thread may append at a time, readers may keep using the track concurrently.
+         * @return The number of points appended, less than the given ones if the capacity is exhausted.
+         */
+        size_t append(std::span<const FlightDataPoint> points);
+
+        /**
+         * @brief Marks the track as complete and builds the time-bucket index, no more points may be appended.
+         */
+        void finalize();
+
+        /**
+         * @return The number of published samples.
+         */
+        size_t size() const;
+        bool empty() const;
+
+        /**
+         * @return The timestamps of the samples, in seconds.
+         */
+        std::span<const float> timestamps() const;
+
+        /**
+         * @return The distance travelled along the track up to each sample, in meters.
+         */
+        std::span<const float> distances() const;
+
+        /**
+         * @return The horizontal speed of the step ending at each sample, in m/s.
+         */
+        std::span<const float> groundSpeeds() const;
+
+        /**
+         * @return The vertical speed of the step ending at each sample, in m/s, positive when climbing.
+         */
+        std::span<const float> verticalSpeeds() const;
+
+        /**
+         * @brief Finds the segment containing the given timestamp using the time-bucket index.
+         * @return The index i such that timestamps[i] <= timestamp < timestamps[i + 1], clamped to the valid segments.
+         */
+        size_t findSegment(float timestamp) const;
+
+        /**
+         * @brief Finds the segment containing the given timestamp, walking from the segment of the cursor if it is close.
+         * @details Falls back to the time-bucket index when the timestamp is more than a few segments away.
+         * The cursor is updated to the found segment.
+         */
+        size_t findSegment(float timestamp, PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Interpolates the track at the given timestamp.
+         * @note Timestamps outside the track are clamped to its first and last samples.
+         */
+        FlightDataPoint interpolate(float timestamp) const;
+
+        /**
+         * @brief Interpolates the track at the given timestamp, starting the lookup from the cursor.
+         * @note Timestamps outside the track are clamped to its first and last samples.
+         */
+        FlightDataPoint interpolate(float timestamp, PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Interpolates the derived channels at the given timestamp, starting the lookup from the cursor.
+         * @note Timestamps outside the track are clamped to its first and last samples.
+         */
+        DerivedChannels interpolateChannels(float timestamp, PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Evaluates the smooth pose of the track at the given timestamp, starting the lookup from the cursor.
+         * @details Positions follow a Catmull-Rom spline through the samples and attitudes are slerped between them, both
+         * evaluated from the four samples around the timestamp. The spline of the last segment depends on the next sample,
+         * so until the track is finalized that segment is interpolated linearly instead.
+         * @note Timestamps outside the track are clamped to its first and last samples.
+         */
+        FlightPose interpolatePose(float timestamp, PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Interpolates the track at many timestamps at once.
+         * @param timestamps The timestamps to interpolate at.
+         * @param points The output points, must be at least as large as timestamps.
+         * @details Segments are located with a single cursor carried across the batch, so sorted timestamps are resolved
+         * in one merge-walk over the track. Unsorted timestamps are still correct, they fall back to the index.
+         * @note Timestamps outside the track are clamped to its first and last samples.
+         */
+        void interpolate(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) const;
+
+      private:
+        /**
+         * @brief Builds the uniform time-bucket index used for random lookups.
+         */
+        void buildBucketIndex();
+
+        /**
+         * @brief Computes the derived channels of the samples in [begin, end) from the samples before them.
+         */
+        void deriveChannels(size_t begin, size_t end);
+
+        /**
+         * @brief Finds the segment containing the given timestamp among the first count samples.
+         */
+        size_t findSegment(float timestamp, size_t count) const;
+        size_t findSegment(float timestamp, size_t count, PlaybackCursor &cursor) const;
+
+        /**
+         * @brief Interpolates the given segment at the given timestamp, the track having count samples.
+         */
+        FlightDataPoint interpolateSegment(size_t segment, float timestamp, size_t count) const;
+
+        std::vector<float> timestamp;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> yaw;
+        std::vector<float> pitch;
+        std::vector<float> roll;
+
+        // Derived channels, computed as samples are appended
+        std::vector<float> groundSpeed;
+        std::vector<float> verticalSpeed;
+        std::vector<float> acceleration;
+        std::vector<float> distance;
+        std::vector<float> headingRate;
+
+        UnitScale unitScale{}; //!< Converts the horizontal positions to meters for the derived channels
+
+        // Readers only access the first sampleCount samples, appends are published by a release store of the new count
+        std::atomic<size_t> sampleCount{0};
+        std::atomic<bool> indexed{false}; //!< Whether the time-bucket index below is built and can be used
+
+        // Uniform time-bucket index: bucket b covers [bucketOrigin + b / bucketScale, bucketOrigin + (b + 1) / bucketScale)
+        // and bucketSegments[b] is the segment containing the start of the bucket
+        std::vector<uint32_t> bucketSegments;
+        float bucketOrigin{0.f};
+        float bucketScale{0.f};
+    };
+} // namespace dfv
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <numbers>
+
 namespace dfv {
     /**
      * @brief A coordinate in latitude, longitude and altitude.
@@ -11,11 +14,40 @@ namespace dfv {
     };
 
     constexpr double SCALING_FACTOR = 100000.0; //  0.00001 = 1.11 meter
+    constexpr double METERS_PER_DEGREE = 111320.0; // Along a meridian, and along the equator
+
+    /**
+     * @brief The length in meters of a unit of relative position, along each horizontal axis.
+     * @details A unit is 0.00001 degrees, so east-west units shrink with the cosine of the latitude while north-south
+     * units stay the same.
+     */
+    struct UnitScale {
+        float east; //!< Meters per unit of relative longitude
+        float north; //!< Meters per unit of relative latitude
+    };
+
+    /**
+     * @brief Returns the length of the units of relative position around the given latitude, in degrees.
+     */
+    inline UnitScale unitScaleAt(const double latitude) {
+        const double metersPerUnit = METERS_PER_DEGREE / SCALING_FACTOR;
+        return {.east = static_cast<float>(metersPerUnit * std::cos(latitude * std::numbers::pi / 180.0)),
+                .north = static_cast<float>(metersPerUnit)};
+    }
+
+    /**
+     * @brief Returns the length in meters of a horizontal step between relative positions.
+     */
+    inline float horizontalDistance(const float dx, const float dz, const UnitScale scale) {
+        const float east = dx * scale.east;
+        const float north = dz * scale.north;
+        return std::sqrt(east * east + north * north);
+    }
 
     /**
      * @brief Calculates the relative position of a coordinate in relation to another coordinate.
      * @note The altitude of the returned coordinate is unchanged.
-     * @return The relative position of the coordinate, in meters.
+     * @return The relative position of the coordinate, in units of 0.00001 degrees (see unitScaleAt()).
      */
     inline Coordinate calculateRelativePosition(const Coordinate &position, const Coordinate &inRelationTo) {
         return {.lat = (position.lat - inRelationTo.lat) * SCALING_FACTOR,
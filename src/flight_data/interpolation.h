@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace dfv {
+    constexpr float TwoPi = 2.f * std::numbers::pi_v<float>;
+    constexpr float InvTwoPi = 1.f / TwoPi;
+
+    inline float lerp(const float start, const float end, const float t) {
+        return start + (end - start) * t;
+    }
+
+    /**
+     * @brief Wraps a difference of angles to [-pi, pi] without branches.
+     */
+    inline float wrapAngle(const float diff) {
+        return diff - TwoPi * std::nearbyint(diff * InvTwoPi);
+    }
+
+    /**
+     * @brief Interpolates an angle in the shortest direction.
+     */
+    inline float lerpAngle(const float start, const float end, const float t) {
+        return start + wrapAngle(end - start) * t;
+    }
+
+    /**
+     * @brief Returns 1 / dt, or 0 for samples sharing a timestamp.
+     * @details Written without a branch so that the loops using it vectorize: a conditional division may trap and
+     * compilers won't if-convert it. The added term is negligible for any real sampling interval.
+     */
+    inline float safeReciprocal(const float dt) {
+        return dt / (dt * dt + 1e-12f);
+    }
+
+    /**
+     * @brief Converts an attitude to a unit quaternion (w, x, y, z) rotating about the y-axis by the yaw, then the x-axis
+     * by the pitch, then the z-axis by the roll.
+     */
+    inline std::array<float, 4> attitudeQuaternion(const float yaw, const float pitch, const float roll) {
+        const float cy = std::cos(yaw * 0.5f), sy = std::sin(yaw * 0.5f);
+        const float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+        const float cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+
+        // The product of the rotations about each axis, yaw * pitch * roll
+        return {cy * cp * cr + sy * sp * sr,
+                cy * sp * cr + sy * cp * sr,
+                sy * cp * cr - cy * sp * sr,
+                cy * cp * sr - sy * sp * cr};
+    }
+} // namespace dfv
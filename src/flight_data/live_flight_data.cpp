@@ -0,0 +1,334 @@
+#include "live_flight_data.h"
+
+#include <array>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace dfv {
+    namespace {
+        constexpr size_t RingCapacity = 1 << 16; //!< The number of points that can be in flight between the threads
+        constexpr size_t ReadSize = 64 << 10; //!< The number of bytes read from the feed at once
+        constexpr size_t InitialTrackCapacity = 1 << 12;
+        constexpr auto PollInterval = std::chrono::milliseconds{50}; //!< How often a file is checked for new data
+        constexpr auto PipeWaitInterval = std::chrono::milliseconds{100}; //!< How often a quiet pipe checks the stop flag
+        constexpr auto BackoffInterval = std::chrono::milliseconds{1}; //!< How long the reader waits when the ring is full
+
+        /**
+         * @brief Unbuffered reads from a file or pipe, returning whatever is available instead of waiting for a full buffer.
+         */
+        class FeedReader {
+          public:
+            explicit FeedReader(const std::filesystem::path &path) {
+#ifdef _WIN32
+                fd = _wopen(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+                fd = open(path.c_str(), O_RDONLY);
+#endif
+                if (fd < 0)
+                    throw std::runtime_error("Failed to open " + path.string());
+            }
+
+            ~FeedReader() {
+#ifdef _WIN32
+                _close(fd);
+#else
+                close(fd);
+#endif
+            }
+
+            FeedReader(const FeedReader &) = delete;
+            FeedReader &operator=(const FeedReader &) = delete;
+
+            /**
+             * @brief Waits up to the given timeout for data to be available.
+             * @return False if nothing arrived in time, true if a read won't block.
+             * @note Throws std::runtime_error if waiting fails.
+             */
+            bool wait(const std::chrono::milliseconds timeout) {
+#ifdef _WIN32
+                // File descriptors can't be polled on Windows, reads block instead
+                return true;
+#else
+                pollfd pollFd{.fd = fd, .events = POLLIN};
+                const int ready = poll(&pollFd, 1, static_cast<int>(timeout.count()));
+                if (ready < 0 && errno != EINTR)
+                    throw std::runtime_error("Failed to wait for live flight data");
+                return ready > 0;
+#endif
+            }
+
+            /**
+             * @return The number of bytes read, 0 at the end of a file or once the writer closed a pipe.
+             * @note Throws std::runtime_error if reading fails.
+             */
+            size_t read(std::span<char> buffer) {
+#ifdef _WIN32
+                const auto count = _read(fd, buffer.data(), static_cast<unsigned int>(buffer.size()));
+#else
+                const auto count = ::read(fd, buffer.data(), buffer.size());
+#endif
+                if (count < 0)
+                    throw std::runtime_error("Failed to read live flight data");
+                return static_cast<size_t>(count);
+            }
+
+          private:
+            int fd;
+        };
+    } // namespace
+
+    LiveFlightData::LiveFlightData(std::filesystem::path path)
+        : path(std::move(path)), ring(RingCapacity), drainBuffer(RingCapacity) {}
+
+    LiveFlightData::~LiveFlightData() {
+        // A reader waiting on a quiet pipe notices within PipeWaitInterval
+        stopReading = true;
+        if (reader.valid())
+            reader.wait();
+    }
+
+    bool LiveFlightData::load() {
+        std::promise<void> firstPoint;
+        auto firstPointFuture = firstPoint.get_future();
+
+        reader = std::async(std::launch::async, [this, firstPoint = std::move(firstPoint)]() mutable {
+            readFeed(firstPoint);
+        });
+
+        std::cout << "Waiting for live flight data from " << path << std::endl;
+        try {
+            firstPointFuture.get();
+        } catch (const std::exception &e) {
+            std::cerr << "Error while loading flight data: " << e.what() << std::endl;
+            return false;
+        }
+
+        // Take in the first point so that the flight data is usable right away
+        update();
+        return true;
+    }
+
+    void LiveFlightData::readFeed(std::promise<void> &firstPoint) {
+        bool started = false;
+
+        try {
+            FeedReader feed{path};
+
+            // Regular files are polled for new data at their end, pipes block until the writer sends some
+            const bool isFile = std::filesystem::is_regular_file(path);
+
+            std::array<char, ReadSize> chunk;
+            std::vector<FlightDataPoint> parsedPoints;
+            std::string pending;
+            std::optional<DjiCsvParser> parser;
+            DjiCsvParser::Row row{};
+            float lastTimestamp = -std::numeric_limits<float>::infinity();
+
+            while (!stopReading) {
+                if (!isFile && !feed.wait(PipeWaitInterval))
+                    continue;
+
+                const size_t readCount = feed.read(chunk);
+                if (readCount == 0) {
+                    if (!isFile)
+                        break; // The writer closed the pipe
+
+                    std::this_thread::sleep_for(PollInterval);
+                    continue;
+                }
+
+                pending.append(chunk.data(), readCount);
+
+                // Only complete rows are parsed, the last partial row waits for the rest of its data
+                const size_t lastNewline = pending.rfind('\n');
+                if (lastNewline == std::string::npos)
+                    continue;
+
+                const char *cursor = pending.data();
+                const char *end = pending.data() + lastNewline + 1;
+
+                if (!parser) {
+                    const auto [header, body] = DjiCsvParser::splitHeader({cursor, end});
+                    if (header.empty())
+                        continue; // Only the delimiter line has arrived yet
+
+                    parser.emplace(header);
+                    cursor = body.data();
+                }
+
+                parsedPoints.clear();
+                while (cursor < end) {
+                    if (!parser->parseRow(cursor, end, row))
+                        continue;
+
+                    if (!started && parsedPoints.empty())
+                        initialPosition = row.coords;
+
+                    // Points already published can't move anymore, rows that go back in time are dropped
+                    const auto point = DjiCsvParser::toPoint(row, initialPosition);
+                    if (point.timestamp < lastTimestamp)
+                        continue;
+                    lastTimestamp = point.timestamp;
+                    parsedPoints.push_back(point);
+                }
+                pending.erase(0, lastNewline + 1);
+
+                // Nothing reads the track before the first point is signalled, so it can still be replaced
+                if (!started && !parsedPoints.empty())
+                    track = FlightTrack{InitialTrackCapacity, initialPosition.lat};
+                appendToTrack(parsedPoints);
+                for (const auto &point : parsedPoints) {
+                    while (!ring.push(point)) {
+                        if (stopReading)
+                            return;
+                        std::this_thread::sleep_for(BackoffInterval);
+                    }
+                }
+
+                if (!started && !parsedPoints.empty()) {
+                    started = true;
+                    firstPoint.set_value();
+                }
+            }
+
+            if (!started)
+                throw std::runtime_error("Live flight data ended before any valid row was received");
+
+            // Nothing is appended anymore, so the last segment's spline and the time-bucket index can be built
+            std::scoped_lock lock{grownTracksMutex};
+            (grownTracks.empty() ? track : grownTracks.back()).finalize();
+        } catch (const std::exception &e) {
+            if (!started)
+                firstPoint.set_exception(std::current_exception());
+            else
+                std::cerr << "Error while reading live flight data: " << e.what() << std::endl;
+        }
+
+        feedClosed.store(true, std::memory_order_release);
+    }
+
+    void LiveFlightData::appendToTrack(const std::span<const FlightDataPoint> newPoints) {
+        FlightTrack *current;
+        {
+            std::scoped_lock lock{grownTracksMutex};
+            current = grownTracks.empty() ? &track : &grownTracks.back();
+        }
+
+        const size_t appended = current->append(newPoints);
+        if (appended < newPoints.size()) {
+            // Out of capacity, move to a track twice as large
+            std::scoped_lock lock{grownTracksMutex};
+            auto &grown = grownTracks.emplace_back(*current, std::max(2 * current->size(), current->size() + newPoints.size()));
+            grown.append(newPoints.subspan(appended));
+            activeTrack.store(&grown, std::memory_order_release);
+        }
+    }
+
+    void LiveFlightData::update() {
+        // Nothing is pushed after the feed is closed, so if it was closed before draining the drain takes in the rest
+        const bool closed = feedClosed.load(std::memory_order_acquire);
+
+        // Drain everything the reader pushed since the last frame
+        size_t count;
+        while ((count = ring.pop(drainBuffer)) > 0) {
+            const std::span<const FlightDataPoint> drained{drainBuffer.data(), count};
+            for (const auto &point : drained) {
+                summary.extend({.lat = static_cast<double>(point.z) / SCALING_FACTOR + initialPosition.lat,
+                                .lon = static_cast<double>(point.x) / SCALING_FACTOR + initialPosition.lon,
+                                .alt = static_cast<double>(point.y)});
+            }
+            points.insert(points.end(), drained.begin(), drained.end());
+        }
+
+        {
+            // Reads of the tracks only last a single call, so every track but the active one can go
+            std::scoped_lock lock{grownTracksMutex};
+            while (grownTracks.size() > 1)
+                grownTracks.pop_front();
+            if (!grownTracks.empty() && !track.empty())
+                track = FlightTrack{};
+        }
+
+        feedDrained = closed;
+    }
+
+    bool LiveFlightData::isLoadComplete() {
+        return feedDrained;
+    }
+
+    seconds_f LiveFlightData::getValidUntil() {
+        return getEndTime();
+    }
+
+    Coordinate LiveFlightData::getInitialPosition() {
+        return initialPosition;
+    }
+
+    FlightDataPoint LiveFlightData::getPoint(seconds_f timestamp) {
+        return currentTrack().interpolate(timestamp.count());
+    }
+
+    FlightDataPoint LiveFlightData::getPoint(seconds_f timestamp, PlaybackCursor &cursor) {
+        return currentTrack().interpolate(timestamp.count(), cursor);
+    }
+
+    void LiveFlightData::getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) {
+        currentTrack().interpolate(timestamps, points);
+    }
+
+    FlightPose LiveFlightData::getPose(seconds_f timestamp, PlaybackCursor &cursor) {
+        return currentTrack().interpolatePose(timestamp.count(), cursor);
+    }
+
+    DerivedChannels LiveFlightData::getChannels(seconds_f timestamp, PlaybackCursor &cursor) {
+        return currentTrack().interpolateChannels(timestamp.count(), cursor);
+    }
+
+    const FlightTrack *LiveFlightData::getTrack() {
+        // The track is replaced by a larger one when it runs out of capacity, which only stops once the feed is closed
+        if (!isLoadComplete())
+            return nullptr;
+        return &currentTrack();
+    }
+
+    float LiveFlightData::getMaximumAltitude() {
+        return summary.maximumAltitude;
+    }
+
+    float LiveFlightData::getMinimumAltitude() {
+        return summary.minimumAltitude;
+    }
+
+    seconds_f LiveFlightData::getDuration() {
+        return seconds_f{currentTrack().timestamps().back()};
+    }
+
+    seconds_f LiveFlightData::getStartTime() {
+        return seconds_f{currentTrack().timestamps().front()};
+    }
+
+    seconds_f LiveFlightData::getEndTime() {
+        return seconds_f{currentTrack().timestamps().back()};
+    }
+
+    FlightBoundingBox LiveFlightData::getBoundingBox() {
+        return summary.boundingBox;
+    }
+
+    const std::vector<FlightDataPoint> &LiveFlightData::getPath() {
+        return points;
+    }
+} // namespace dfv
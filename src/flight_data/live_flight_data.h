@@ -0,0 +1,94 @@
+#pragma once
+
+#include "dji_csv_parser.h"
+#include "flight_data.h"
+#include "flight_track.h"
+
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <utils/spsc_ring_buffer.h>
+
+namespace dfv {
+    /**
+     * @brief Flight data of a flight in progress, read from a DJI CSV log as it is being written.
+     * @details A reader thread follows the file (or named pipe), appends the parsed points to the track and pushes them
+     * through a lock-free ring buffer, which update() drains on the render thread every frame for the path and the
+     * bounding box. Regular files are followed indefinitely, pipes until the writer closes them.
+     */
+    class LiveFlightData : public FlightData {
+      public:
+        explicit LiveFlightData(std::filesystem::path path);
+        ~LiveFlightData() override;
+
+        /**
+         * @brief Starts following the feed and waits for its first valid row.
+         */
+        bool load() override;
+        void update() override;
+        bool isLoadComplete() override;
+        seconds_f getValidUntil() override;
+
+        Coordinate getInitialPosition() override;
+        FlightDataPoint getPoint(seconds_f timestamp) override;
+        FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor &cursor) override;
+        void getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) override;
+        FlightPose getPose(seconds_f timestamp, PlaybackCursor &cursor) override;
+        DerivedChannels getChannels(seconds_f timestamp, PlaybackCursor &cursor) override;
+        const FlightTrack *getTrack() override;
+        float getMaximumAltitude() override;
+        float getMinimumAltitude() override;
+
+        seconds_f getDuration() override;
+        seconds_f getStartTime() override;
+        seconds_f getEndTime() override;
+
+        FlightBoundingBox getBoundingBox() override;
+        const std::vector<FlightDataPoint> &getPath() override;
+
+      private:
+        /**
+         * @brief Reads and parses the feed until it is closed or the reader is stopped, runs on the reader thread.
+         * @param firstPoint Fulfilled once the first point is pushed, or with the error that prevented it.
+         */
+        void readFeed(std::promise<void> &firstPoint);
+
+        /**
+         * @brief Appends points to the track, moving to a larger track if it is full, runs on the reader thread.
+         */
+        void appendToTrack(std::span<const FlightDataPoint> newPoints);
+
+        /**
+         * @return The track readers interpolate, the last one grown by the reader thread.
+         */
+        const FlightTrack &currentTrack() const {
+            return *activeTrack.load(std::memory_order_acquire);
+        }
+
+        const std::filesystem::path path;
+        Coordinate initialPosition{}; //!< Written by the reader thread before the first point is pushed
+
+        SpscRingBuffer<FlightDataPoint> ring; //!< Points parsed by the reader thread and not yet drained
+        std::atomic<bool> stopReading{false};
+        std::atomic<bool> feedClosed{false}; //!< Set by the reader thread after its last push and finalizing the track
+
+        // Appended to by the reader thread only. A full track is replaced by a larger one, the previous tracks are kept
+        // until update() as the render thread may still be reading them
+        FlightTrack track;
+        std::deque<FlightTrack> grownTracks;
+        std::atomic<const FlightTrack *> activeTrack{&track};
+        std::mutex grownTracksMutex; //!< Guards the deque of grown tracks, not the tracks themselves
+
+        // Only accessed by the render thread
+        std::vector<FlightDataPoint> drainBuffer;
+        std::vector<FlightDataPoint> points;
+        FlightSummary summary;
+        bool feedDrained{false}; //!< Whether the feed is closed and all of its points were drained
+
+        std::future<void> reader; //!< Declared last so that the reader is waited upon before anything else is destroyed
+    };
+} // namespace dfv
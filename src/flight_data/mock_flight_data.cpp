@@ -1,10 +1,13 @@
 #include "mock_flight_data.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numbers>
 #include <utility>
 
-#define M_PI 3.14159265358979323846f
-
 namespace dfv {
+    static constexpr float Pi = std::numbers::pi_v<float>;
+
     static constexpr std::array dataset = {
             FlightDataPoint{0.0,      2.0, 0.0,      0.0,      0.0, 0.0, 0.0},
             FlightDataPoint{1.0,  1.41421, 0.0,  1.41421, 0.628319, 0.0, 0.0},
@@ -38,25 +41,27 @@ namespace dfv {
     }
 
     FlightDataPoint MockFlightData::getPoint(seconds_f timestamp) {
+        PlaybackCursor cursor{};
+        return getPoint(timestamp, cursor);
+    }
+
+    FlightDataPoint MockFlightData::getPoint(seconds_f timestamp, PlaybackCursor &cursor) {
         // Use the modulo of the timestamp to wrap around the data set
         float time = std::fmod(timestamp.count(), float{dataset.size()});
 
-        // Find the data point after the one we want
-        auto nextPointIt = std::upper_bound(dataset.begin(), dataset.end(), time, [](float value, const FlightDataPoint &point) {
-            return value < point.timestamp;
-        });
-
-        // Find the current data point
-        auto pointIt = [&] {
-            if (nextPointIt != dataset.begin())
-                return std::prev(nextPointIt);
-            else
-                return dataset.end() - 1; // Wrap around if we're at the first data point
-        }();
+        // Walk from the last segment to the one containing the time, the last point wraps around to the first
+        constexpr size_t lastPoint = dataset.size() - 1;
+        size_t segment = std::min(cursor.segment, lastPoint);
+        while (segment > 0 && time < dataset[segment].timestamp)
+            segment--;
+        if (time < dataset[segment].timestamp)
+            segment = lastPoint; // Wrap around if we're before the first data point
+        while (segment < lastPoint && time >= dataset[segment + 1].timestamp)
+            segment++;
+        cursor.segment = segment;
 
-        // Wrap around if we're at the last data point
-        if (nextPointIt == dataset.end())
-            nextPointIt = dataset.begin();
+        const auto pointIt = dataset.begin() + segment;
+        const auto nextPointIt = segment == lastPoint ? dataset.begin() : std::next(pointIt);
 
         // Interpolate between the current point and the next one
         float lerpTime = time - pointIt->timestamp;
@@ -68,10 +73,10 @@ namespace dfv {
         auto lerpAngle = [&](float start, float end) {
             float diff = end - start;
             // Lerp the angle in the shortest direction
-            if (diff > M_PI)
-                diff -= 2 * M_PI;
-            else if (diff < -M_PI)
-                diff += 2 * M_PI;
+            if (diff > Pi)
+                diff -= 2 * Pi;
+            else if (diff < -Pi)
+                diff += 2 * Pi;
 
             return start + diff * lerpTime;
         };
@@ -109,7 +114,7 @@ namespace dfv {
         return boundingBox;
     }
 
-    std::vector<FlightDataPoint> &MockFlightData::getPath() {
+    const std::vector<FlightDataPoint> &MockFlightData::getPath() {
         static std::vector<FlightDataPoint> path{dataset.begin(), dataset.end()};
         return path;
     }
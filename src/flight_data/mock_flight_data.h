@@ -11,6 +11,7 @@ namespace dfv {
 
         Coordinate getInitialPosition() override;
         FlightDataPoint getPoint(seconds_f timestamp) override;
+        FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor &cursor) override;
 
         seconds_f getDuration() override;
         seconds_f getStartTime() override;
@@ -19,6 +20,6 @@ namespace dfv {
         float getMinimumAltitude() override;
 
         FlightBoundingBox getBoundingBox() override;
-        std::vector<FlightDataPoint> &getPath() override;
+        const std::vector<FlightDataPoint> &getPath() override;
     };
 } // namespace dfv
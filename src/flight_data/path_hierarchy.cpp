@@ -0,0 +1,154 @@
+#include "path_hierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <utility>
+
+namespace dfv {
+    namespace {
+        constexpr size_t MaxLevels = 16;
+        constexpr size_t ChunkPoints = 1 << 12; //!< The number of segments simplified independently of the rest of the path
+
+        /**
+         * @brief Returns the squared distance of p from the segment between a and b.
+         */
+        float segmentDistanceSquared(const FlightDataPoint &p, const FlightDataPoint &a, const FlightDataPoint &b) {
+            const float abX = b.x - a.x, abY = b.y - a.y, abZ = b.z - a.z;
+            const float apX = p.x - a.x, apY = p.y - a.y, apZ = p.z - a.z;
+
+            const float lengthSquared = abX * abX + abY * abY + abZ * abZ;
+            const float t = lengthSquared > 0.f ? std::clamp((apX * abX + apY * abY + apZ * abZ) / lengthSquared, 0.f, 1.f) : 0.f;
+
+            const float dX = apX - abX * t, dY = apY - abY * t, dZ = apZ - abZ * t;
+            return dX * dX + dY * dY + dZ * dZ;
+        }
+
+        /**
+         * @brief Simplifies the path with the Douglas-Peucker algorithm, always keeping its first and last points.
+         * @details The distance is measured from segments rather than infinite lines, which keeps the error bounded when
+         * simplifying an already simplified path.
+         * @param keep Set to 1 for every interior point that is kept, must be the same size as the path. The first and
+         * last points are left for the caller to mark, so that paths sharing an endpoint can be simplified concurrently.
+         */
+        void douglasPeucker(std::span<const FlightDataPoint> path, const float tolerance, std::span<uint8_t> keep) {
+            if (path.empty())
+                return;
+
+            const float toleranceSquared = tolerance * tolerance;
+            // Iterative to avoid deep recursion on long, noisy paths
+            std::vector<std::pair<size_t, size_t>> ranges;
+            ranges.emplace_back(0, path.size() - 1);
+            while (!ranges.empty()) {
+                const auto [first, last] = ranges.back();
+                ranges.pop_back();
+
+                float maxDistance = -1.f;
+                size_t farthest = first;
+                for (size_t i = first + 1; i < last; i++) {
+                    const float distance = segmentDistanceSquared(path[i], path[first], path[last]);
+                    if (distance > maxDistance) {
+                        maxDistance = distance;
+                        farthest = i;
+                    }
+                }
+
+                if (maxDistance > toleranceSquared) {
+                    keep[farthest] = 1;
+                    ranges.emplace_back(first, farthest);
+                    ranges.emplace_back(farthest, last);
+                }
+            }
+        }
+
+        /**
+         * @brief Simplifies the path in fixed-size chunks processed concurrently, chunk boundaries are always kept.
+         * @details Bounding the chunk size also bounds the quadratic worst case of Douglas-Peucker on noisy paths.
+         */
+        std::vector<FlightDataPoint> simplify(std::span<const FlightDataPoint> path, const float tolerance, const unsigned int threadCount) {
+            std::vector<uint8_t> keep(path.size(), 0);
+
+            // Consecutive chunks share their boundary point, so that the segments between chunks are preserved. The
+            // boundaries are marked before the chunks are simplified, which then only write their interior points
+            const size_t chunkCount = std::max<size_t>(1, (path.size() + ChunkPoints - 2) / ChunkPoints);
+            if (!path.empty()) {
+                for (size_t chunk = 0; chunk < chunkCount; chunk++)
+                    keep[chunk * ChunkPoints] = 1;
+                keep.back() = 1;
+            }
+            const auto simplifyChunks = [&](const size_t firstChunk, const size_t lastChunk) {
+                for (size_t chunk = firstChunk; chunk < lastChunk; chunk++) {
+                    const size_t first = chunk * ChunkPoints;
+                    const size_t count = std::min(ChunkPoints + 1, path.size() - first);
+                    douglasPeucker(path.subspan(first, count), tolerance, std::span{keep}.subspan(first, count));
+                }
+            };
+
+            const size_t workerCount = std::min<size_t>(chunkCount, threadCount);
+            if (workerCount == 1) {
+                simplifyChunks(0, chunkCount);
+            } else {
+                std::vector<std::future<void>> futures;
+                futures.reserve(workerCount);
+                for (size_t worker = 0; worker < workerCount; worker++)
+                    futures.push_back(std::async(std::launch::async, simplifyChunks, chunkCount * worker / workerCount,
+                                                 chunkCount * (worker + 1) / workerCount));
+                for (auto &future : futures)
+                    future.get();
+            }
+
+            std::vector<FlightDataPoint> simplified;
+            simplified.reserve(static_cast<size_t>(std::count(keep.begin(), keep.end(), 1)));
+            for (size_t i = 0; i < path.size(); i++) {
+                if (keep[i])
+                    simplified.push_back(path[i]);
+            }
+
+            return simplified;
+        }
+    } // namespace
+
+    PathHierarchy::PathHierarchy(std::span<const FlightDataPoint> path, const float finestError, unsigned int threadCount) {
+        if (path.empty())
+            return;
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        hierarchy.push_back({.maxError = finestError, .points = simplify(path, finestError, threadCount)});
+
+        // Each level simplifies the previous one: its points are within the previous error of the path and the
+        // simplification moves them by at most the difference, so the errors add up to the level's error
+        while (hierarchy.size() < MaxLevels && hierarchy.back().points.size() > 2) {
+            const auto &previous = hierarchy.back();
+            const float maxError = previous.maxError * 2.f;
+
+            auto points = simplify(previous.points, maxError - previous.maxError, threadCount);
+            hierarchy.push_back({.maxError = maxError, .points = std::move(points)});
+        }
+    }
+
+    bool PathHierarchy::empty() const {
+        return hierarchy.empty();
+    }
+
+    const std::vector<PathHierarchy::Level> &PathHierarchy::levels() const {
+        return hierarchy;
+    }
+
+    const PathHierarchy::Level &PathHierarchy::selectLevel(const float maxError) const {
+        // Levels are sorted by increasing error, find the last one within the given error
+        const auto it = std::upper_bound(hierarchy.begin(), hierarchy.end(), maxError, [](const float error, const Level &level) {
+            return error < level.maxError;
+        });
+        return it == hierarchy.begin() ? hierarchy.front() : *std::prev(it);
+    }
+
+    float PathHierarchy::screenToWorldError(const float pixelError, const float distance, const float fovY, const float viewportHeight) {
+        // The height of the view frustum at the given distance, spread over the pixels of the viewport
+        const float metersPerPixel = 2.f * distance * std::tan(fovY / 2.f) / viewportHeight;
+        return pixelError * metersPerPixel;
+    }
+} // namespace dfv
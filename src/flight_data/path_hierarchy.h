@@ -0,0 +1,52 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "flight_data.h"
+
+namespace dfv {
+    /**
+     * @brief A hierarchy of increasingly simplified versions of a flight path, for drawing it at different zoom levels.
+     * @details Each level is simplified with the Douglas-Peucker algorithm so that no sample of the original path is
+     * further than the level's error from it, measured in meters in 3D. The error doubles from one level to the next.
+     */
+    class PathHierarchy {
+      public:
+        struct Level {
+            float maxError; //!< The maximum distance of any original sample from this level, in meters
+            std::vector<FlightDataPoint> points;
+        };
+
+        PathHierarchy() = default;
+
+        /**
+         * @brief Builds the hierarchy for the given path.
+         * @param finestError The error of the first level, in meters.
+         * @param threadCount The number of threads each level is split across, 0 to use all hardware threads.
+         */
+        explicit PathHierarchy(std::span<const FlightDataPoint> path, float finestError = 0.5f, unsigned int threadCount = 0);
+
+        bool empty() const;
+        const std::vector<Level> &levels() const;
+
+        /**
+         * @brief Returns the coarsest level whose error is within the given one, or the finest level if none is.
+         * @note Must not be called on an empty hierarchy.
+         */
+        const Level &selectLevel(float maxError) const;
+
+        /**
+         * @brief Converts an error on screen to the world error it corresponds to for a perspective camera.
+         * @param pixelError The tolerated error, in pixels.
+         * @param distance The distance from the camera to the path, in meters.
+         * @param fovY The vertical field of view of the camera, in radians.
+         * @param viewportHeight The height of the viewport, in pixels.
+         * @return The tolerated error, in meters.
+         */
+        static float screenToWorldError(float pixelError, float distance, float fovY, float viewportHeight);
+
+      private:
+        std::vector<Level> hierarchy;
+    };
+} // namespace dfv
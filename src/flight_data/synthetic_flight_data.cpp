@@ -0,0 +1,236 @@
+#include "synthetic_flight_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <numbers>
+#include <thread>
+
+#include <utils/time_types.h>
+
+namespace dfv {
+    namespace {
+        constexpr double MetersPerDegree = 111320.0; //!< The length of a degree of latitude
+        constexpr double Gravity = 9.81;
+        constexpr double GustPeriod = 4.0; //!< The time between independent values of the low-frequency noise, in seconds
+        constexpr double SensorNoise = 0.2; //!< The amplitude of the per-sample noise relative to the low-frequency noise
+        constexpr double UndulationPeriod = 120.0; //!< In seconds
+        constexpr double UndulationAmplitude = 0.3; //!< Relative to the cruise altitude
+        constexpr double MaxClimbTime = 60.0; //!< The longest climb and descent of the mission profile, in seconds
+        constexpr size_t MinChunkSize = 1 << 16; //!< The fewest samples generated by each thread
+
+        /**
+         * @brief The splitmix64 finalizer, a cheap hash with good avalanche.
+         */
+        uint64_t mix(uint64_t value) {
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        /**
+         * @brief Returns a pseudorandom value in [-1, 1) determined by the seed, the noise channel and the index only.
+         */
+        double hashUniform(const uint64_t seed, const uint64_t channel, const uint64_t index) {
+            const uint64_t hash = mix(seed ^ mix(channel ^ mix(index)));
+            return static_cast<double>(hash >> 11) * 0x1p-52 - 1.0;
+        }
+
+        /**
+         * @brief Smooth noise in [-1, 1], interpolating random values placed at integer positions.
+         */
+        double valueNoise(const uint64_t seed, const uint64_t channel, const double position) {
+            const double knot = std::floor(position);
+            const double t = position - knot;
+            const double smooth = t * t * (3.0 - 2.0 * t);
+
+            const auto index = static_cast<uint64_t>(static_cast<int64_t>(knot));
+            const double start = hashUniform(seed, channel, index);
+            const double end = hashUniform(seed, channel, index + 1);
+            return start + (end - start) * smooth;
+        }
+
+        double smoothstep(const double t) {
+            const double clamped = std::clamp(t, 0.0, 1.0);
+            return clamped * clamped * (3.0 - 2.0 * clamped);
+        }
+
+        double altitudeAt(const SyntheticFlightOptions &options, const double time) {
+            const double cruise = options.cruiseAltitude;
+            switch (options.altitudeProfile) {
+                case AltitudeProfile::Constant:
+                    return cruise;
+                case AltitudeProfile::Mission: {
+                    const double climbTime = std::min(MaxClimbTime, options.duration * 0.1);
+                    if (climbTime <= 0.0)
+                        return cruise;
+                    return cruise * smoothstep(time / climbTime) * smoothstep((options.duration - time) / climbTime);
+                }
+                case AltitudeProfile::Undulating:
+                    return cruise * (1.0 + UndulationAmplitude * std::sin(2.0 * std::numbers::pi * time / UndulationPeriod));
+            }
+            return cruise;
+        }
+
+        /**
+         * @brief Generates the samples in [first, last).
+         */
+        void generateRange(const SyntheticFlightOptions &options, const size_t first, const size_t last,
+                           std::span<FlightDataPoint> points) {
+            // A 2:3 Lissajous figure spanning the area, starting at the origin. Its average speed is about
+            // extent * frequency * 1.217, from which the frequency giving the requested speed is derived.
+            const double extent = options.extent;
+            const double frequency = extent > 0.0 ? options.speed / (extent * 1.217) : 0.0;
+            const double northFrequency = frequency * 1.5;
+
+            const double unitsPerMeterNorth = SCALING_FACTOR / MetersPerDegree;
+            const double unitsPerMeterEast = unitsPerMeterNorth / std::cos(options.origin.lat * std::numbers::pi / 180.0);
+
+            for (size_t i = first; i < last; i++) {
+                // Computed from the index rather than accumulated, so that every chunk agrees on the timestamps
+                const double time = static_cast<double>(i) / options.sampleRate;
+
+                const double east = extent * std::sin(frequency * time);
+                const double north = extent * std::sin(northFrequency * time);
+                const double velocityEast = extent * frequency * std::cos(frequency * time);
+                const double velocityNorth = extent * northFrequency * std::cos(northFrequency * time);
+                const double accelerationEast = -extent * frequency * frequency * std::sin(frequency * time);
+                const double accelerationNorth = -extent * northFrequency * northFrequency * std::sin(northFrequency * time);
+
+                // The attitude follows the smooth path, the noise stands for wind and sensor errors
+                const double speedSquared = velocityEast * velocityEast + velocityNorth * velocityNorth;
+                const double speed = std::sqrt(speedSquared);
+                const double turnRate = speedSquared > 0.0 ? (velocityEast * accelerationNorth - velocityNorth * accelerationEast) / speedSquared : 0.0;
+                const double tangentialAcceleration = speed > 0.0 ? (velocityEast * accelerationEast + velocityNorth * accelerationNorth) / speed : 0.0;
+
+                const double gustPosition = time / GustPeriod;
+                const auto noise = [&](const uint64_t channel) {
+                    return options.noise * (valueNoise(options.seed, channel, gustPosition) +
+                                            SensorNoise * hashUniform(options.seed, channel + 3, i));
+                };
+
+                const double altitude = std::max(0.0, altitudeAt(options, time) + noise(2));
+                points[i] = {.timestamp = static_cast<float>(time),
+                             .x = static_cast<float>((east + noise(0)) * unitsPerMeterEast),
+                             .y = static_cast<float>(altitude),
+                             .z = static_cast<float>((north + noise(1)) * unitsPerMeterNorth),
+                             .yaw = static_cast<float>(std::atan2(velocityEast, velocityNorth)),
+                             .pitch = static_cast<float>(-std::atan(tangentialAcceleration / Gravity)),
+                             .roll = static_cast<float>(std::atan(speed * turnRate / Gravity))};
+            }
+        }
+    } // namespace
+
+    SyntheticFlightData::SyntheticFlightData(SyntheticFlightOptions options) : options(options) {}
+
+    std::vector<FlightDataPoint> SyntheticFlightData::generate(const SyntheticFlightOptions &options, unsigned int threadCount) {
+        if (!(options.duration >= 0.f) || !(options.sampleRate > 0.f))
+            return {};
+
+        const auto sampleCount = static_cast<size_t>(std::floor(static_cast<double>(options.duration) * options.sampleRate)) + 1;
+        std::vector<FlightDataPoint> points(sampleCount);
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunkCount = std::clamp<size_t>(sampleCount / MinChunkSize, 1, threadCount);
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            futures.push_back(std::async(std::launch::async, generateRange, std::cref(options), sampleCount * chunk / chunkCount,
+                                         sampleCount * (chunk + 1) / chunkCount, std::span{points}));
+        }
+        for (auto &future : futures)
+            future.get();
+
+        return points;
+    }
+
+    bool SyntheticFlightData::load() {
+        const auto startTime = clock::now();
+        points = generate(options);
+        if (points.empty()) {
+            std::cerr << "Error while loading flight data: invalid synthetic flight options" << std::endl;
+            return false;
+        }
+        std::cout << "Synthetic flight generated in " << duration_cast<milliseconds>(clock::now() - startTime).count()
+                  << "ms (" << points.size() << " points)" << std::endl;
+
+        const auto [minX, maxX] = std::minmax_element(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.x < b.x; });
+        const auto [minY, maxY] = std::minmax_element(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.y < b.y; });
+        const auto [minZ, maxZ] = std::minmax_element(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.z < b.z; });
+        boundingBox = {.llLat = static_cast<double>(minZ->z) / SCALING_FACTOR + options.origin.lat,
+                       .llLon = static_cast<double>(minX->x) / SCALING_FACTOR + options.origin.lon,
+                       .urLat = static_cast<double>(maxZ->z) / SCALING_FACTOR + options.origin.lat,
+                       .urLon = static_cast<double>(maxX->x) / SCALING_FACTOR + options.origin.lon};
+        minimumAltitude = minY->y;
+        maximumAltitude = maxY->y;
+
+        track = FlightTrack{points, options.origin.lat};
+        pathHierarchy = PathHierarchy{points};
+        return true;
+    }
+
+    Coordinate SyntheticFlightData::getInitialPosition() {
+        return options.origin;
+    }
+
+    FlightDataPoint SyntheticFlightData::getPoint(seconds_f timestamp) {
+        return track.interpolate(timestamp.count());
+    }
+
+    FlightDataPoint SyntheticFlightData::getPoint(seconds_f timestamp, PlaybackCursor &cursor) {
+        return track.interpolate(timestamp.count(), cursor);
+    }
+
+    void SyntheticFlightData::getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) {
+        track.interpolate(timestamps, points);
+    }
+
+    FlightPose SyntheticFlightData::getPose(seconds_f timestamp, PlaybackCursor &cursor) {
+        return track.interpolatePose(timestamp.count(), cursor);
+    }
+
+    DerivedChannels SyntheticFlightData::getChannels(seconds_f timestamp, PlaybackCursor &cursor) {
+        return track.interpolateChannels(timestamp.count(), cursor);
+    }
+
+    const FlightTrack *SyntheticFlightData::getTrack() {
+        return &track;
+    }
+
+    float SyntheticFlightData::getMaximumAltitude() {
+        return maximumAltitude;
+    }
+
+    float SyntheticFlightData::getMinimumAltitude() {
+        return minimumAltitude;
+    }
+
+    seconds_f SyntheticFlightData::getDuration() {
+        return seconds_f{track.timestamps().back()};
+    }
+
+    seconds_f SyntheticFlightData::getStartTime() {
+        return seconds_f{track.timestamps().front()};
+    }
+
+    seconds_f SyntheticFlightData::getEndTime() {
+        return seconds_f{track.timestamps().back()};
+    }
+
+    FlightBoundingBox SyntheticFlightData::getBoundingBox() {
+        return boundingBox;
+    }
+
+    const std::vector<FlightDataPoint> &SyntheticFlightData::getPath() {
+        return points;
+    }
+
+    std::span<const FlightDataPoint> SyntheticFlightData::getSimplifiedPath(const float maxError) {
+        if (pathHierarchy.empty())
+            return {};
+        return pathHierarchy.selectLevel(maxError).points;
+    }
+} // namespace dfv
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "flight_data.h"
+#include "flight_track.h"
+#include "geo_types.h"
+#include "path_hierarchy.h"
+
+namespace dfv {
+    /**
+     * @brief How the altitude of a synthetic flight changes over time.
+     */
+    enum class AltitudeProfile {
+        Constant, //!< Always at the cruise altitude
+        Mission, //!< Climbs to the cruise altitude, holds it and descends back to the ground at the end
+        Undulating, //!< Oscillates around the cruise altitude
+    };
+
+    /**
+     * @brief Parameters of a synthetic flight.
+     */
+    struct SyntheticFlightOptions {
+        float duration = 600.f; //!< The duration of the flight in seconds
+        float sampleRate = 10.f; //!< The number of samples per second
+        float extent = 2000.f; //!< The half-size of the square area the flight stays within, in meters
+        float speed = 15.f; //!< The average ground speed in m/s
+        float cruiseAltitude = 120.f; //!< In meters
+        AltitudeProfile altitudeProfile = AltitudeProfile::Mission;
+        float noise = 0.5f; //!< The amplitude of the position noise in meters, 0 for a perfectly smooth path
+        uint64_t seed = 1; //!< Flights generated with the same options and seed are identical
+        Coordinate origin = {.lat = 45.5009309, .lon = 9.1553888, .alt = 0.0}; //!< Where the flight starts
+    };
+
+    /**
+     * @brief A deterministic synthetic flight, for exercising the visualizer at scale without any log on disk.
+     * @details The path is a Lissajous figure filling the configured area, with the attitude following its direction and
+     * turns. Noise is a function of the seed and of the sample index only, so that the flight can be generated in
+     * parallel chunks and is the same whatever the number of threads.
+     */
+    class SyntheticFlightData : public FlightData {
+      public:
+        explicit SyntheticFlightData(SyntheticFlightOptions options = {});
+
+        /**
+         * @brief Generates the points of a synthetic flight.
+         * @param threadCount The number of threads to generate with, 0 to use all hardware threads.
+         */
+        static std::vector<FlightDataPoint> generate(const SyntheticFlightOptions &options, unsigned int threadCount = 0);
+
+        bool load() override;
+
+        Coordinate getInitialPosition() override;
+        FlightDataPoint getPoint(seconds_f timestamp) override;
+        FlightDataPoint getPoint(seconds_f timestamp, PlaybackCursor &cursor) override;
+        void getPoints(std::span<const seconds_f> timestamps, std::span<FlightDataPoint> points) override;
+        FlightPose getPose(seconds_f timestamp, PlaybackCursor &cursor) override;
+        DerivedChannels getChannels(seconds_f timestamp, PlaybackCursor &cursor) override;
+        const FlightTrack *getTrack() override;
+        float getMaximumAltitude() override;
+        float getMinimumAltitude() override;
+
+        seconds_f getDuration() override;
+        seconds_f getStartTime() override;
+        seconds_f getEndTime() override;
+
+        FlightBoundingBox getBoundingBox() override;
+        const std::vector<FlightDataPoint> &getPath() override;
+        std::span<const FlightDataPoint> getSimplifiedPath(float maxError) override;
+
+      private:
+        const SyntheticFlightOptions options;
+        std::vector<FlightDataPoint> points;
+        FlightTrack track;
+        PathHierarchy pathHierarchy;
+        FlightBoundingBox boundingBox{};
+        float maximumAltitude = 0;
+        float minimumAltitude = 0;
+    };
+} // namespace dfv
@@ -0,0 +1,246 @@
+#include "telemetry_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include <utils/time_types.h>
+
+#include "csv_tokenizer.h"
+#include "dji_csv_parser.h"
+
+namespace dfv {
+    using namespace csv_tokenizer;
+
+    TelemetryStore::TelemetryStore(const std::filesystem::path &path, std::string_view timeColumn, unsigned int threadCount,
+                                   const std::atomic<bool> *cancel)
+        : file(path), threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+          cancelIndex(cancel) {
+        const auto [header, headerBody] = DjiCsvParser::splitHeader(file.data());
+        body = headerBody;
+
+        const char *p = header.data();
+        const char *end = header.data() + header.size();
+        while (p <= end) {
+            names.emplace_back(trim(nextField(p, end)));
+            if (p >= end)
+                break;
+            p++; // Skip the delimiter
+        }
+
+        const auto time = std::find(names.begin(), names.end(), timeColumn);
+        if (time == names.end())
+            throw std::runtime_error("Flight data is missing the time column " + std::string{timeColumn});
+        this->timeColumn = static_cast<size_t>(time - names.begin());
+
+        columns.resize(names.size());
+        decodings.resize(names.size());
+        indexRows();
+        if (isCancelled())
+            throw std::runtime_error("Telemetry indexing was cancelled");
+    }
+
+    TelemetryStore::~TelemetryStore() {
+        cancelDecoding = true;
+        std::scoped_lock lock{columnsMutex};
+        for (const auto &decoding : decodings) {
+            if (decoding.valid())
+                decoding.wait();
+        }
+    }
+
+    const std::vector<std::string> &TelemetryStore::columnNames() const {
+        return names;
+    }
+
+    bool TelemetryStore::hasColumn(std::string_view name) const {
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    size_t TelemetryStore::rowCount() const {
+        return rows;
+    }
+
+    size_t TelemetryStore::blockCount() const {
+        return blocks.size();
+    }
+
+    size_t TelemetryStore::columnIndex(std::string_view name) const {
+        const auto it = std::find(names.begin(), names.end(), name);
+        if (it == names.end())
+            throw std::runtime_error("Flight data has no column " + std::string{name});
+        return static_cast<size_t>(it - names.begin());
+    }
+
+    std::shared_future<void> TelemetryStore::requestColumn(const size_t column) {
+        std::scoped_lock lock{columnsMutex};
+        if (!decodings[column].valid()) {
+            columns[column] = std::make_unique<TelemetryColumn>();
+            decodings[column] = std::async(std::launch::async, [this, column, &decoded = *columns[column]] {
+                const auto startTime = clock::now();
+                decodeColumn(column, decoded);
+                if (!isCancelled()) {
+                    std::cout << "Telemetry column " << names[column] << " decoded in "
+                              << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms" << std::endl;
+                }
+            }).share();
+        }
+        return decodings[column];
+    }
+
+    const TelemetryColumn &TelemetryStore::column(std::string_view name) {
+        const size_t index = columnIndex(name);
+        requestColumn(index).wait();
+
+        // Only written before the decoding was ready
+        return *columns[index];
+    }
+
+    const TelemetryColumn *TelemetryStore::tryColumn(std::string_view name) {
+        const size_t index = columnIndex(name);
+        if (requestColumn(index).wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+            return nullptr;
+        return columns[index].get();
+    }
+
+    std::optional<size_t> TelemetryStore::rowAt(const float timestamp) {
+        const TelemetryColumn *times = tryColumn(names[timeColumn]);
+        if (!times)
+            return std::nullopt;
+
+        const auto it = std::partition_point(times->values.begin(), times->values.end(), [timestamp](const float time) {
+            return time < timestamp;
+        });
+        return std::min(static_cast<size_t>(it - times->values.begin()), times->values.size() - 1);
+    }
+
+    bool TelemetryStore::isCancelled() const {
+        return cancelDecoding.load(std::memory_order_relaxed) || (cancelIndex && cancelIndex->load(std::memory_order_relaxed));
+    }
+
+    std::span<const char> TelemetryStore::blockData(const size_t block) const {
+        const size_t end = block + 1 < blocks.size() ? blocks[block + 1].offset : body.size();
+        return body.subspan(blocks[block].offset, end - blocks[block].offset);
+    }
+
+    template<typename Fn>
+    void TelemetryStore::forEachBlock(Fn &&fn) const {
+        // Blocks are handed out one at a time, rows are not equally long across a log
+        std::atomic<size_t> nextBlock{0};
+        const auto work = [&] {
+            for (size_t block = nextBlock++; block < blocks.size() && !isCancelled(); block = nextBlock++)
+                fn(block);
+        };
+
+        const auto workerCount = static_cast<unsigned int>(std::min<size_t>(blocks.size(), threadCount));
+        std::vector<std::future<void>> workers;
+        workers.reserve(workerCount);
+        for (unsigned int worker = 1; worker < workerCount; worker++)
+            workers.push_back(std::async(std::launch::async, work));
+        work();
+        for (auto &worker : workers)
+            worker.get();
+    }
+
+    void TelemetryStore::indexRows() {
+        // Block boundaries only need a newline search each, so they are placed up front
+        const char *end = body.data() + body.size();
+        for (size_t offset = 0; offset < body.size();) {
+            blocks.push_back({.offset = offset, .firstRow = 0});
+
+            const char *split = body.data() + std::min(offset + BlockSize, body.size());
+            if (split != end) {
+                const auto *newline = static_cast<const char *>(std::memchr(split - 1, '\n', end - split + 1));
+                split = newline ? newline + 1 : end;
+            }
+            offset = static_cast<size_t>(split - body.data());
+        }
+
+        // Counting the rows of each block is what tokenizing needs to know where its values go
+        std::vector<size_t> blockRows(blocks.size());
+        forEachBlock([&](const size_t block) {
+            const auto data = blockData(block);
+            const char *p = data.data();
+            const char *blockEnd = data.data() + data.size();
+            size_t count = 0;
+            while (true) {
+                skipBlankLines(p, blockEnd);
+                if (p == blockEnd)
+                    break;
+                p = skipRow(p, blockEnd);
+                count++;
+            }
+            blockRows[block] = count;
+        });
+
+        for (size_t block = 0; block < blocks.size(); block++) {
+            blocks[block].firstRow = rows;
+            rows += blockRows[block];
+        }
+    }
+
+    void TelemetryStore::decodeColumn(const size_t column, TelemetryColumn &decoded) const {
+        constexpr float NaN = std::numeric_limits<float>::quiet_NaN();
+        decoded.values.assign(rows, NaN);
+
+        std::vector<std::pair<float, float>> blockRanges(blocks.size(), {NaN, NaN});
+        forEachBlock([&](const size_t block) {
+            const auto data = blockData(block);
+            const char *p = data.data();
+            const char *end = data.data() + data.size();
+            float *out = decoded.values.data() + blocks[block].firstRow;
+
+            float minimum = std::numeric_limits<float>::infinity();
+            float maximum = -std::numeric_limits<float>::infinity();
+            while (true) {
+                skipBlankLines(p, end);
+                if (p == end)
+                    break;
+
+                // Tokenize only up to the requested column, the rest of the row is skipped by searching its end
+                std::string_view field{};
+                bool found = false;
+                for (size_t i = 0; i <= column; i++) {
+                    field = nextField(p, end);
+                    if (i == column) {
+                        found = true;
+                        break;
+                    }
+                    if (p >= end || *p == '\n')
+                        break;
+                    p++; // Skip the delimiter
+                }
+                if (p < end && *p == '\n')
+                    p++;
+                else
+                    p = skipRow(p, end);
+
+                float value;
+                if (found && parseNumber(field, value)) {
+                    *out = value;
+                    minimum = std::min(minimum, value);
+                    maximum = std::max(maximum, value);
+                }
+                out++;
+            }
+
+            if (minimum <= maximum)
+                blockRanges[block] = {minimum, maximum};
+        });
+
+        decoded.minimum = NaN;
+        decoded.maximum = NaN;
+        for (const auto &[minimum, maximum] : blockRanges) {
+            if (std::isnan(minimum))
+                continue;
+            decoded.minimum = std::isnan(decoded.minimum) ? minimum : std::min(decoded.minimum, minimum);
+            decoded.maximum = std::isnan(decoded.maximum) ? maximum : std::max(decoded.maximum, maximum);
+        }
+    }
+} // namespace dfv
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utils/mapped_file.h>
+
+namespace dfv {
+    /**
+     * @brief A decoded telemetry column.
+     */
+    struct TelemetryColumn {
+        std::vector<float> values; //!< One value per row, NaN where the field is empty or not a number
+        float minimum; //!< The smallest valid value, NaN if there are none
+        float maximum; //!< The largest valid value, NaN if there are none
+    };
+
+    /**
+     * @brief Every column of a CSV flight log, decoded on demand.
+     * @details Only the header and the layout of the rows are read on construction: the body is split in row-aligned
+     * blocks of about BlockSize bytes and the byte offset and first row of each block are recorded. A column is decoded
+     * in the background the first time it is requested, with the blocks spread across threads, and cached from then on,
+     * so that logs with hundreds of columns only pay for the ones actually used.
+     *
+     * Values are kept as they appear in the file, without any unit conversion, and rows are in file order. Empty lines
+     * are not rows.
+     * @note Rows containing quoted newlines may be split incorrectly if a block boundary falls inside them.
+     */
+    class TelemetryStore {
+      public:
+        static constexpr size_t BlockSize = 256 << 10; //!< The approximate size of a row block, in bytes
+
+        /**
+         * @brief Maps the CSV at the given path and indexes its rows.
+         * @param timeColumn The column holding the timestamp of each row in seconds, used by rowAt().
+         * @param threadCount The number of threads used to index and decode, 0 to use all hardware threads.
+         * @param cancel If set while indexing, the construction stops early. Must outlive the store.
+         * @note Throws std::runtime_error if the file cannot be mapped, has no time column or indexing was cancelled.
+         */
+        TelemetryStore(const std::filesystem::path &path, std::string_view timeColumn, unsigned int threadCount = 0,
+                       const std::atomic<bool> *cancel = nullptr);
+
+        /**
+         * @brief Stops the columns being decoded and waits for them.
+         */
+        ~TelemetryStore();
+
+        const std::vector<std::string> &columnNames() const;
+        bool hasColumn(std::string_view name) const;
+        size_t rowCount() const;
+        size_t blockCount() const;
+
+        /**
+         * @brief Returns the column with the given name, waiting for it to be decoded if this is the first access.
+         * @details The returned reference stays valid for the lifetime of the store.
+         * @note Throws std::runtime_error if there is no such column.
+         */
+        const TelemetryColumn &column(std::string_view name);
+
+        /**
+         * @brief Returns the column with the given name if it is decoded, otherwise starts decoding it in the background.
+         * @return The column, valid for the lifetime of the store, or null while it is being decoded.
+         * @note Throws std::runtime_error if there is no such column.
+         */
+        const TelemetryColumn *tryColumn(std::string_view name);
+
+        /**
+         * @brief Returns the first row at or after the given timestamp, clamped to the last row.
+         * @details Rows are assumed to be in time order, as logs are written.
+         * @return The row, or an empty optional while the time column is being decoded, which starts on first use.
+         * @note Must not be called on a store without rows.
+         */
+        std::optional<size_t> rowAt(float timestamp);
+
+      private:
+        struct RowBlock {
+            size_t offset; //!< The offset of the block's first row in the body
+            size_t firstRow; //!< The index of the block's first row
+        };
+
+        /**
+         * @brief Returns the bytes of the given block.
+         */
+        std::span<const char> blockData(size_t block) const;
+
+        /**
+         * @brief Calls fn(block) for every block, spread across the store's threads.
+         */
+        template<typename Fn>
+        void forEachBlock(Fn &&fn) const;
+
+        /**
+         * @brief Returns the index of the column with the given name.
+         * @note Throws std::runtime_error if there is no such column.
+         */
+        size_t columnIndex(std::string_view name) const;
+
+        /**
+         * @brief Returns the decoding of the given column, starting it if this is the first request.
+         */
+        std::shared_future<void> requestColumn(size_t column);
+
+        /**
+         * @return Whether the work in progress should stop, because the store or its construction is being cancelled.
+         */
+        bool isCancelled() const;
+
+        void indexRows();
+        void decodeColumn(size_t column, TelemetryColumn &decoded) const;
+
+        const MappedFile file;
+        const unsigned int threadCount;
+        std::span<const char> body; //!< The rows following the header
+        std::vector<std::string> names;
+        size_t timeColumn;
+        std::vector<RowBlock> blocks;
+        size_t rows{0};
+
+        const std::atomic<bool> *cancelIndex; //!< Stops the construction, null if it can't be cancelled
+        std::atomic<bool> cancelDecoding{false}; //!< Set on destruction to stop the columns being decoded
+
+        std::mutex columnsMutex; //!< Guards the entries of columns and decodings, which are filled in lazily
+        // One entry per column, null until requested. A column's values may only be read once its decoding is ready.
+        std::vector<std::unique_ptr<TelemetryColumn>> columns;
+        std::vector<std::shared_future<void>> decodings;
+    };
+} // namespace dfv
@@ -0,0 +1,198 @@
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "map/box_distance.h"
+#include "utils/time_types.h"
+
+namespace {
+    using BoxMatrix = std::pmr::vector<std::pmr::vector<dfv::structs::DiscreteBoxInfo>>;
+
+    /**
+     * @brief Creates a matrix of boxes, the given ones on the path.
+     * @details Seeds the distances like createGrid: the boxes on the path are at distance 0 and the ones around them at
+     * distance 1, except for the boxes on the edge of the matrix, which don't seed anything.
+     */
+    BoxMatrix seedMatrix(const int rows, const int cols, const std::vector<std::pair<int, int>> &path) {
+        BoxMatrix matrix(rows, std::pmr::vector<dfv::structs::DiscreteBoxInfo>(cols));
+        for (const auto &[i, j] : path)
+            matrix[i][j].is_on_path = true;
+
+        for (int i = 1; i < rows - 1; i++) {
+            for (int j = 1; j < cols - 1; j++) {
+                if (!matrix[i][j].is_on_path)
+                    continue;
+                for (int di = -1; di <= 1; di++) {
+                    for (int dj = -1; dj <= 1; dj++) {
+                        if (matrix[i + di][j + dj].distance != 0)
+                            matrix[i + di][j + dj].distance = 1;
+                    }
+                }
+                matrix[i][j].distance = 0;
+            }
+        }
+        return matrix;
+    }
+
+    /**
+     * @brief The whole-grid sweeps createGrid used before the breadth-first search, repeated until nothing changes.
+     * @details Kept as the reference the search must match.
+     */
+    void sweepBoxDistances(BoxMatrix &box_matrix) {
+        const int rows = static_cast<int>(box_matrix.size());
+        const int cols = static_cast<int>(box_matrix[0].size());
+        int max_iterations = 1000;
+        int iter = 0;
+        bool no_changes = false;
+        while (!no_changes && iter < max_iterations) {
+            no_changes = true;
+            for (int i = 0; i < rows; i++) {
+                for (int j = 0; j < cols; j++) {
+                    int closest = INT_MAX;
+                    bool iter_changes = false;
+                    for (int a = 1; a < rows; a++) {
+                        if (i - a > 0) {
+                            if (box_matrix[i - a][j].distance < closest) {
+                                closest = box_matrix[i - a][j].distance + a;
+                                iter_changes = true;
+                            }
+                        }
+                        if (i + a < rows) {
+                            if (box_matrix[i + a][j].distance < closest) {
+                                closest = box_matrix[i + a][j].distance + a;
+                                iter_changes = true;
+                            }
+                        }
+                        if (j - a > 0) {
+                            if (box_matrix[i][j - a].distance < closest) {
+                                closest = box_matrix[i][j - a].distance + a;
+                                iter_changes = true;
+                            }
+                        }
+                        if (j + a < cols) {
+                            if (box_matrix[i][j + a].distance < closest) {
+                                closest = box_matrix[i][j + a].distance + a;
+                                iter_changes = true;
+                            }
+                        }
+                        if (iter_changes) {
+                            break;
+                        }
+                    }
+                    if (box_matrix[i][j].distance <= closest) {
+                        continue;
+                    }
+                    box_matrix[i][j].distance = closest;
+                    no_changes = false;
+                }
+            }
+            iter++;
+        }
+    }
+
+    bool sameDistances(const BoxMatrix &a, const BoxMatrix &b) {
+        for (size_t i = 0; i < a.size(); i++) {
+            for (size_t j = 0; j < a[i].size(); j++) {
+                if (a[i][j].distance != b[i][j].distance)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief The average time taken to propagate the distances of the given matrix, in milliseconds.
+     */
+    template<typename Propagate>
+    float timePropagation(const BoxMatrix &seeded, const int repetitions, Propagate &&propagate) {
+        dfv::milliseconds_f total{0};
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            BoxMatrix matrix = seeded;
+            const auto startTime = dfv::clock::now();
+            propagate(matrix);
+            total += dfv::clock::now() - startTime;
+        }
+        return total.count() / static_cast<float>(repetitions);
+    }
+} // namespace
+
+/*
+ * Checks the breadth-first search propagating the distance from the drone path to the terrain boxes against the
+ * sweeps it replaced, then times both on a large grid.
+ *
+ * Command line usage: dfv_grid_benchmark [options]
+ * Options:
+ *   --grids N: the number of random grids checked, 3000 by default
+ *   --seed N: the seed of the random grids, 0 by default
+ *   --check-only: only check the random grids, without timing the large grid
+ */
+int main(const int argc, char **argv) {
+    int gridCount = 3000;
+    unsigned int seed = 0;
+    bool checkOnly = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--grids" && hasValue)
+            gridCount = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--check-only")
+            checkOnly = true;
+        else
+            std::cerr << "Unused argument: '" << arg << "'" << std::endl;
+    }
+
+    // Random grids from 1x1 to 25x25, each with a few random boxes on the path
+    std::mt19937 random{seed};
+    std::uniform_int_distribution<int> side{1, 25};
+    int mismatches = 0;
+    for (int grid = 0; grid < gridCount; grid++) {
+        const int rows = side(random);
+        const int cols = side(random);
+        std::vector<std::pair<int, int>> path;
+        for (int count = std::uniform_int_distribution<int>{0, 5}(random); count > 0; count--)
+            path.emplace_back(std::uniform_int_distribution<int>{0, rows - 1}(random),
+                              std::uniform_int_distribution<int>{0, cols - 1}(random));
+
+        BoxMatrix searched = seedMatrix(rows, cols, path);
+        BoxMatrix swept = searched;
+        dfv::map::propagateBoxDistances(searched);
+        sweepBoxDistances(swept);
+        if (!sameDistances(searched, swept)) {
+            std::cerr << "Distances differ on grid " << grid << " (" << rows << "x" << cols << ")" << std::endl;
+            mismatches++;
+        }
+    }
+    std::cout << "Checked " << gridCount << " random grids, " << mismatches << " differ from the sweeps" << std::endl;
+    if (checkOnly)
+        return mismatches == 0 ? 0 : 1;
+
+    constexpr int Side = 200;
+    std::vector<std::pair<int, int>> diagonal;
+    for (int k = 1; k < Side - 1; k++)
+        diagonal.emplace_back(k, k);
+    const std::vector<std::pair<std::string_view, std::vector<std::pair<int, int>>>> paths = {
+            {"box at top-left corner", {{1, 1}}},
+            {"diagonal across grid", diagonal},
+            {"box at bottom-right", {{Side - 2, Side - 2}}},
+    };
+
+    std::cout << "On a " << Side << "x" << Side << " box grid:" << std::endl;
+    std::cout << std::left << std::setw(24) << "path" << std::right << std::setw(12) << "sweeps" << std::setw(12) << "BFS" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto &[name, path] : paths) {
+        const BoxMatrix seeded = seedMatrix(Side, Side, path);
+        const float sweepTime = timePropagation(seeded, 3, sweepBoxDistances);
+        const float searchTime = timePropagation(seeded, 20, dfv::map::propagateBoxDistances);
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(9) << sweepTime << " ms"
+                  << std::setw(9) << searchTime << " ms" << std::endl;
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+#include "flight_data/flight_library.h"
+
+namespace {
+    /**
+     * @brief Parses a time given as YYYY-MM-DD, optionally followed by THH:MM[:SS].
+     * @return The time in seconds since the epoch, or an empty optional if malformed.
+     */
+    std::optional<int64_t> parseTime(const char *text) {
+        int year, month, day, hour = 0, minute = 0, second = 0;
+        const int fields = std::sscanf(text, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+        if (fields != 3 && fields < 5)
+            return std::nullopt;
+
+        const std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{static_cast<unsigned int>(month)},
+                                              std::chrono::day{static_cast<unsigned int>(day)}};
+        if (!ymd.ok())
+            return std::nullopt;
+
+        const auto days = std::chrono::sys_days{ymd}.time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::seconds>(days).count() + hour * 3600 + minute * 60 + second;
+    }
+
+    /**
+     * @brief Parses an area given as LAT,LON,LAT,LON, the corners in any order.
+     */
+    std::optional<dfv::FlightBoundingBox> parseArea(const char *text) {
+        double lat0, lon0, lat1, lon1;
+        if (std::sscanf(text, "%lf,%lf,%lf,%lf", &lat0, &lon0, &lat1, &lon1) != 4)
+            return std::nullopt;
+
+        return dfv::FlightBoundingBox{.llLat = std::min(lat0, lat1),
+                                      .llLon = std::min(lon0, lon1),
+                                      .urLat = std::max(lat0, lat1),
+                                      .urLon = std::max(lon0, lon1)};
+    }
+
+    void printTime(const int64_t time) {
+        const std::chrono::sys_seconds seconds{std::chrono::seconds{time}};
+        const auto days = std::chrono::floor<std::chrono::days>(seconds);
+        const std::chrono::year_month_day ymd{days};
+        const std::chrono::hh_mm_ss timeOfDay{seconds - days};
+        std::cout << std::setfill('0') << static_cast<int>(ymd.year()) << '-' << std::setw(2)
+                  << static_cast<unsigned int>(ymd.month()) << '-' << std::setw(2) << static_cast<unsigned int>(ymd.day())
+                  << ' ' << std::setw(2) << timeOfDay.hours().count() << ':' << std::setw(2) << timeOfDay.minutes().count()
+                  << ':' << std::setw(2) << timeOfDay.seconds().count() << std::setfill(' ');
+    }
+
+    int usage() {
+        std::cout << "Usage:\n"
+                  << "  dfv_library index <directory> [--output FILE] [--threads N]\n"
+                  << "  dfv_library query <index> [--area LAT,LON,LAT,LON] [--from TIME] [--to TIME]\n"
+                  << "TIME is YYYY-MM-DD, optionally followed by THH:MM[:SS], in the local time of the logs" << std::endl;
+        return 1;
+    }
+} // namespace
+
+/*
+ * The entrypoint of the flight library tool, which indexes directories of flight logs and finds the flights that
+ * crossed an area or time range without opening every log.
+ *
+ * Command line usage:
+ *   dfv_library index <directory> [options]: scans every CSV in the directory and its subdirectories
+ *     --output FILE: where to write the index, flights.dfvidx in the directory by default
+ *     --threads N: the number of logs scanned at once, all hardware threads by default
+ *   dfv_library query <index> [options]: prints the flights matching every given option
+ *     --area LAT,LON,LAT,LON: flights whose bounding box intersects the area between the two corners
+ *     --from TIME: flights still in the air at or after the time
+ *     --to TIME: flights that started at or before the time
+ */
+int main(const int argc, char **argv) {
+    if (argc < 3)
+        return usage();
+
+    const std::string_view command = argv[1];
+    const std::filesystem::path target = argv[2];
+
+    try {
+        if (command == "index") {
+            std::filesystem::path output = target / "flights.dfvidx";
+            unsigned int threadCount = 0;
+            for (int i = 3; i < argc; i++) {
+                const std::string_view arg = argv[i];
+                if (arg == "--output" && i + 1 < argc)
+                    output = argv[++i];
+                else if (arg == "--threads" && i + 1 < argc)
+                    threadCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+                else
+                    std::cout << "Unused argument: '" << arg << "'" << std::endl;
+            }
+
+            dfv::FlightLibrary::build(target, output, threadCount);
+            return 0;
+        }
+
+        if (command != "query")
+            return usage();
+
+        dfv::LibraryQuery query{};
+        for (int i = 3; i < argc; i++) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--area" && hasValue) {
+                query.area = parseArea(argv[++i]);
+                if (!query.area)
+                    return usage();
+            } else if ((arg == "--from" || arg == "--to") && hasValue) {
+                const auto time = parseTime(argv[++i]);
+                if (!time)
+                    return usage();
+                (arg == "--from" ? query.from : query.to) = *time;
+            } else {
+                std::cout << "Unused argument: '" << arg << "'" << std::endl;
+            }
+        }
+
+        const dfv::FlightLibrary library{target};
+        const auto startTime = dfv::clock::now();
+        const auto flights = library.query(query);
+        const auto queryTime = duration_cast<dfv::milliseconds_f>(dfv::clock::now() - startTime);
+
+        for (const auto &flight : flights) {
+            printTime(flight.startTime);
+            std::cout << "  " << std::setw(7) << std::lround(flight.duration) << "s  " << flight.path.string() << '\n';
+        }
+        std::cout << flights.size() << " of " << library.flightCount() << " flights found in " << queryTime.count()
+                  << "ms" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "box_distance.h"
+
+#include <cstdint>
+
+namespace dfv::map {
+    void propagateBoxDistances(std::pmr::vector<std::pmr::vector<structs::DiscreteBoxInfo>> &box_matrix) {
+        const int rows = static_cast<int>(box_matrix.size());
+        const int cols = rows > 0 ? static_cast<int>(box_matrix[0].size()) : 0;
+        const auto cols_stride = static_cast<uint32_t>(cols);
+        auto *resource = box_matrix.get_allocator().resource();
+
+        // The search runs on a flat copy of the distances, box (i, j) is at index i * cols + j, which keeps the
+        // neighbours of a box a fixed offset away instead of in another row's allocation
+        std::pmr::vector<int> distances{static_cast<size_t>(rows) * cols, resource};
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++)
+                distances[static_cast<size_t>(i) * cols + j] = box_matrix[i][j].distance;
+        }
+
+        // Every box is queued at most once, in order of distance: the boxes on the path, then the ones around them
+        std::pmr::vector<uint32_t> queue{resource};
+        queue.reserve(distances.size());
+        for (uint32_t index = 0; index < distances.size(); index++) {
+            if (distances[index] == 0)
+                queue.push_back(index);
+        }
+        for (uint32_t index = 0; index < distances.size(); index++) {
+            if (distances[index] == 1)
+                queue.push_back(index);
+        }
+
+        for (size_t head = 0; head < queue.size(); head++) {
+            const uint32_t index = queue[head];
+            const uint32_t i = index / cols_stride;
+            const uint32_t j = index % cols_stride;
+            const int next = distances[index] + 1;
+            const auto visit = [&](const uint32_t neighbour) {
+                if (distances[neighbour] > next) {
+                    distances[neighbour] = next;
+                    queue.push_back(neighbour);
+                }
+            };
+
+            if (i > 0)
+                visit(index - cols_stride);
+            if (i > 0 && i + 1 < static_cast<uint32_t>(rows))
+                visit(index + cols_stride);
+            if (j > 0)
+                visit(index - 1);
+            if (j > 0 && j + 1 < cols_stride)
+                visit(index + 1);
+        }
+
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++)
+                box_matrix[i][j].distance = distances[static_cast<size_t>(i) * cols + j];
+        }
+    }
+} // namespace dfv::map
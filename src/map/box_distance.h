@@ -0,0 +1,14 @@
+#pragma once
+
+#include "structs/data_structs.h"
+#include <memory_resource>
+#include <vector>
+
+namespace dfv::map {
+    /// Propagate the distance from the drone path to every box of the matrix with a multi-source breadth-first search,
+    /// in O(boxes). A box is one further than its closest neighbour, but boxes on the first row and column don't pass
+    /// their distance on to the boxes below and to the right of them
+    /// \param box_matrix The boxes, those on the path at distance 0 and the ones around them at distance 1. The distance
+    /// of every other box must be larger than the distance it is given
+    void propagateBoxDistances(std::pmr::vector<std::pmr::vector<structs::DiscreteBoxInfo>> &box_matrix);
+} // namespace dfv::map
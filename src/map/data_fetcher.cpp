@@ -1,25 +1,94 @@
 #define _USE_MATH_DEFINES
 #define NOMINMAX // Disable min and max macros from windows.h
 #include "data_fetcher.h"
+#include "box_distance.h"
 #include "flight_data/geo_types.h"
 #include "vulkan/vk_mesh.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <math.h>
 #include <utils/env.h>
 #include <cpr/cpr.h>
 #include <cstdlib> // Include for getenv
+#include <future>
 #include <glm/geometric.hpp>
 #include <iostream>
+#include <limits>
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <thread>
 #include <utils/time_types.h>
 
 namespace dfv::map {
     namespace {
         constexpr int BATCH_SIZE_GOOGLE = 500;
         constexpr int BATCH_SIZE = 5000;
+        constexpr size_t SEAM_BLOCK_SIZE = 16; //!< The number of boxes sewn by each task of the parallel seam pass
+
+        /// Call mark(i, j) for every box a segment passes through, in order, with a DDA walk
+        /// \param u0, v0 The start of the segment in box units, box (i, j) covers [i, i + 1) x [j, j + 1)
+        /// \param u1, v1 The end of the segment in box units
+        template<typename Mark>
+        void walkBoxes(const double u0, const double v0, const double u1, const double v1, Mark &&mark) {
+            int i = static_cast<int>(std::floor(u0));
+            int j = static_cast<int>(std::floor(v0));
+            const int endI = static_cast<int>(std::floor(u1));
+            const int endJ = static_cast<int>(std::floor(v1));
+            mark(i, j);
+
+            // How far along the segment the next box boundary is crossed on each axis, and how far apart boundaries are
+            constexpr double never = std::numeric_limits<double>::infinity();
+            const double du = u1 - u0;
+            const double dv = v1 - v0;
+            const int stepI = du > 0 ? 1 : -1;
+            const int stepJ = dv > 0 ? 1 : -1;
+            const double deltaU = du != 0 ? std::abs(1 / du) : never;
+            const double deltaV = dv != 0 ? std::abs(1 / dv) : never;
+            double nextU = du > 0 ? (i + 1 - u0) / du : du < 0 ? (u0 - i) / -du : never;
+            double nextV = dv > 0 ? (j + 1 - v0) / dv : dv < 0 ? (v0 - j) / -dv : never;
+
+            // Every step crosses one boundary, the count makes the walk end exactly on the last box
+            for (int steps = std::abs(endI - i) + std::abs(endJ - j); steps > 0; steps--) {
+                if (nextU < nextV) {
+                    i += stepI;
+                    nextU += deltaU;
+                } else {
+                    j += stepJ;
+                    nextV += deltaV;
+                }
+                mark(i, j);
+            }
+        }
+
+        /// Run work(i) for every i in [0, count) on every core, handing out the indices one at a time
+        template<typename Work>
+        void parallelFor(const size_t count, Work &&work) {
+            const size_t worker_count = std::clamp<size_t>(count, 1, std::max(1u, std::thread::hardware_concurrency()));
+            std::atomic<size_t> next{0};
+            const auto run = [&] {
+                for (size_t i = next++; i < count; i = next++)
+                    work(i);
+            };
+
+            std::vector<std::future<void>> workers;
+            workers.reserve(worker_count - 1);
+            for (size_t worker = 1; worker < worker_count; worker++)
+                workers.push_back(std::async(std::launch::async, run));
+            run();
+            for (auto &worker : workers)
+                worker.get();
+        }
+
+        /// The number of nodes along each side of a box of the given sparsity, corners included
+        int nodesPerSide(float sparsity) {
+            const double baseDensity = 1.0;
+            float densityScale = std::sqrt(10000.0 / sparsity);
+            float innerNodes = std::max(0.0, std::floor(baseDensity * densityScale) - 1);
+            return static_cast<int>(innerNodes) + 2;
+        }
     }
 
     using namespace dfv::structs;
@@ -54,7 +123,7 @@ namespace dfv::map {
     }
 
 
-    void PopulateBatchWithElevationOpenElevation(std::vector<std::reference_wrapper<structs::Node *>> &nodes) {
+    void PopulateBatchWithElevationOpenElevation(std::span<const float> lat, std::span<const float> lon, std::span<float> elev) {
         int max_iter = 100;
         int i = 0;
         while (i < max_iter) {
@@ -62,12 +131,12 @@ namespace dfv::map {
             StringBuffer s;
             Writer<StringBuffer> writer(s);
             writer.StartArray();
-            for (const auto &node : nodes) {
+            for (size_t k = 0; k < lat.size(); k++) {
                 writer.StartObject();
                 writer.Key("latitude");
-                writer.Double(node.get()->lat);
+                writer.Double(lat[k]);
                 writer.Key("longitude");
-                writer.Double(node.get()->lon);
+                writer.Double(lon[k]);
                 writer.EndObject();
             }
             writer.EndArray();
@@ -112,10 +181,10 @@ namespace dfv::map {
                 const rapidjson::Value &result = results[i];
                 if (!result.HasMember("elevation") || !result.HasMember("latitude") || !result.HasMember("longitude")) {
                     std::cerr << "Missing data in result #" << i << std::endl;
-                    nodes[i].get()->elev = 0;
+                    elev[i] = 0;
                     continue;
                 }
-                nodes[i].get()->elev = result["elevation"].GetDouble();
+                elev[i] = result["elevation"].GetDouble();
                 // Add logging here to see what's being set
                 // std::cout << "Node #" << i << " elevation set to: " << nodes[i].get().elev << std::endl;
             }
@@ -123,16 +192,16 @@ namespace dfv::map {
         }
     }
 
-    void PopulateBatchWithElevationGoogle(std::vector<std::reference_wrapper<structs::Node *>> &nodes, std::string &googleApiKey) {
+    void PopulateBatchWithElevationGoogle(std::span<const float> lat, std::span<const float> lon, std::span<float> elev, std::string &googleApiKey) {
         int max_iter = 100;
         int i = 0;
         while (i < max_iter) {
             // Construct locations string for Google Elevation API
             std::string locationsParam;
-            for (const auto &node : nodes) {
+            for (size_t k = 0; k < lat.size(); k++) {
                 if (!locationsParam.empty())
                     locationsParam += "|";
-                locationsParam += std::to_string(node.get()->lat) + "," + std::to_string(node.get()->lon);
+                locationsParam += std::to_string(lat[k]) + "," + std::to_string(lon[k]);
             }
 
             // Send request to Google Elevation API
@@ -171,16 +240,16 @@ namespace dfv::map {
                 const Value &result = results[j];
                 if (!result.HasMember("elevation")) {
                     std::cerr << "Missing elevation data in result #" << j << std::endl;
-                    nodes[j].get()->elev = 0;
+                    elev[j] = 0;
                     continue;
                 }
-                nodes[j].get()->elev = result["elevation"].GetDouble();
+                elev[j] = result["elevation"].GetDouble();
             }
             return;
         }
     }
 
-    void populateElevation(std::vector<structs::Node *> *nodes) {
+    void populateElevation(structs::TerrainPoints &points) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
         std::string execPath = GetExecutablePath();
@@ -192,7 +261,7 @@ namespace dfv::map {
 
         std::string googleApiKey = env["GOOGLE_API_KEY"];
 
-        std::cout << "Fetching " << nodes->size() << " Nodes Elevation" << std::endl;
+        std::cout << "Fetching " << points.size() << " Nodes Elevation" << std::endl;
         int batch_size = 0;
         if (googleApiKey.empty()) {
             batch_size = BATCH_SIZE;
@@ -201,21 +270,22 @@ namespace dfv::map {
         }
 
         int e = 0;
-        for (int i = 0; i < nodes->size(); i += batch_size) {
-            auto startIter = nodes->begin() + i;
-            auto endIter = nodes->begin() + (nodes->size() > i + batch_size ? i + batch_size : nodes->size());
-
-            std::vector<std::reference_wrapper<structs::Node *>> batch(startIter, endIter);
+        for (size_t i = 0; i < points.size(); i += batch_size) {
+            // The points are contiguous, so a batch is a slice of each array
+            const size_t count = std::min<size_t>(batch_size, points.size() - i);
+            const std::span<const float> lat{points.lat.data() + i, count};
+            const std::span<const float> lon{points.lon.data() + i, count};
+            const std::span<float> elev{points.elev.data() + i, count};
 
             if (googleApiKey.empty()) {
-                PopulateBatchWithElevationOpenElevation(batch);
+                PopulateBatchWithElevationOpenElevation(lat, lon, elev);
             } else {
-                PopulateBatchWithElevationGoogle(batch, googleApiKey);
+                PopulateBatchWithElevationGoogle(lat, lon, elev, googleApiKey);
             }
 
              // Ensure PopulateBatchWithElevation is compatible with this change.
             std::chrono::milliseconds(10);
-            std::cout << "Batch " << e << "/" << (nodes->size() / batch_size) + 1 << " of Elevation Data Fetched" << std::endl;
+            std::cout << "Batch " << e << "/" << (points.size() / batch_size) + 1 << " of Elevation Data Fetched" << std::endl;
             e++;
         }
         auto endTime = std::chrono::high_resolution_clock::now();
@@ -223,61 +293,63 @@ namespace dfv::map {
         std::cout << "Elevation data fetched in " << duration.count() << "ms" << std::endl;
     }
 
-    void sewBoxesSlave(std::vector<Node> &commonNodes, std::vector<Node> &sparseNodes, Mesh &mesh, int orientation) {
-        bool reverseOrientationX = sparseNodes[0].game_node->x > commonNodes[0].game_node->x;
-        bool reverseOrientationZ = sparseNodes[0].game_node->z > commonNodes[0].game_node->z;
+    void sewBoxesSlave(const TerrainPoints &points, std::span<const Vertex> vertices, std::span<const uint32_t> commonNodes, std::span<const uint32_t> sparseNodes, std::vector<uint32_t> &indices, int orientation) {
+        const glm::vec3 &sparseStart = vertices[sparseNodes[0]].position;
+        const glm::vec3 &commonStart = vertices[commonNodes[0]].position;
+        bool reverseOrientationX = sparseStart.x > commonStart.x;
+        bool reverseOrientationZ = sparseStart.z > commonStart.z;
         int sparseIndex = 0;
         for (int k = 0; k < commonNodes.size() - 1; ++k) {
-            if(orientation == 1 && commonNodes[k].lat < sparseNodes[sparseIndex].lat){
+            if(orientation == 1 && points.lat[commonNodes[k]] < points.lat[sparseNodes[sparseIndex]]){
                 continue;
             }
             if (sparseIndex + 2 > sparseNodes.size() ) {
                 break;
             }
 
-            Node commonNode = commonNodes[k];
-            Node sparseNode = sparseNodes[sparseIndex];
-            Node nextCommonNode = commonNodes[k + 1];
-            Node nextSparseNode = sparseNodes[sparseIndex + 1];
-            if (commonNode.lat == nextCommonNode.lat && commonNode.lon == nextCommonNode.lon) {
+            uint32_t commonNode = commonNodes[k];
+            uint32_t sparseNode = sparseNodes[sparseIndex];
+            uint32_t nextCommonNode = commonNodes[k + 1];
+            uint32_t nextSparseNode = sparseNodes[sparseIndex + 1];
+            if (points.lat[commonNode] == points.lat[nextCommonNode] && points.lon[commonNode] == points.lon[nextCommonNode]) {
                 continue;
             }
-            if(orientation == 1 && (commonNode.lon == sparseNode.lon || nextCommonNode.lon == nextSparseNode.lon || commonNode.lon == nextSparseNode.lon)) {
+            if(orientation == 1 && (points.lon[commonNode] == points.lon[sparseNode] || points.lon[nextCommonNode] == points.lon[nextSparseNode] || points.lon[commonNode] == points.lon[nextSparseNode])) {
                 throw std::runtime_error("Same lon on horizontal sewing, precondition error");
             }
-            if(orientation == 0 && (commonNode.lat == sparseNode.lat || nextCommonNode.lat == nextSparseNode.lat || commonNode.lat == nextSparseNode.lat)) {
+            if(orientation == 0 && (points.lat[commonNode] == points.lat[sparseNode] || points.lat[nextCommonNode] == points.lat[nextSparseNode] || points.lat[commonNode] == points.lat[nextSparseNode])) {
                 throw std::runtime_error("Same lat on vertical sewing, precondition error");
             }
             if (orientation == 1) {
                 if(reverseOrientationX){
-                    if (nextCommonNode.lat != nextSparseNode.lat) {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
+                    if (points.lat[nextCommonNode] != points.lat[nextSparseNode]) {
+                        indices.push_back(sparseNode);
+                        indices.push_back(commonNode);
+                        indices.push_back(nextCommonNode);
                     } else {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
+                        indices.push_back(sparseNode);
+                        indices.push_back(commonNode);
+                        indices.push_back(nextCommonNode);
 
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextSparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(nextSparseNode);
+                        indices.push_back(sparseNode);
 
                         sparseIndex++;
                     }
                 } else {
-                    if (nextCommonNode.lat != nextSparseNode.lat) {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
+                    if (points.lat[nextCommonNode] != points.lat[nextSparseNode]) {
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(commonNode);
                     } else {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(commonNode);
 
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextSparseNode.game_node->vertex_index);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextSparseNode);
 
                         sparseIndex++;
                     }
@@ -285,34 +357,34 @@ namespace dfv::map {
             }
             if (orientation == 0) {
                 if(reverseOrientationZ){
-                    if (nextCommonNode.lon != nextSparseNode.lon) {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
+                    if (points.lon[nextCommonNode] != points.lon[nextSparseNode]) {
+                        indices.push_back(sparseNode);
+                        indices.push_back(commonNode);
+                        indices.push_back(nextCommonNode);
                     } else {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
+                        indices.push_back(sparseNode);
+                        indices.push_back(commonNode);
+                        indices.push_back(nextCommonNode);
 
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextSparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(nextSparseNode);
+                        indices.push_back(sparseNode);
 
                         sparseIndex++;
                     }
                 } else {
-                    if (nextCommonNode.lon != nextSparseNode.lon) {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
+                    if (points.lon[nextCommonNode] != points.lon[nextSparseNode]) {
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(commonNode);
                     } else {
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(commonNode.game_node->vertex_index);
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(commonNode);
 
-                        mesh.indices.push_back(nextCommonNode.game_node->vertex_index);
-                        mesh.indices.push_back(sparseNode.game_node->vertex_index);
-                        mesh.indices.push_back(nextSparseNode.game_node->vertex_index);
+                        indices.push_back(nextCommonNode);
+                        indices.push_back(sparseNode);
+                        indices.push_back(nextSparseNode);
 
                         sparseIndex++;
                     }
@@ -337,17 +409,18 @@ namespace dfv::map {
     }
 
     /// Create a complex grid around the drone flight path. Creates a 3 blocks wide dense area around the drone and decreases the density of dots by density/(node_density_coefficient^block_distance)
-    /// \param box Box that includes all the drone_path points. Behavior is undefined otherwise
-    /// \param drone_path Vector of dots where the drone has been. The PATH on the edge of the box is ignored.
+    /// \param box Box that includes all the drone_paths points. Behavior is undefined otherwise
+    /// \param drone_paths Vectors of dots where the drone has been, one per flight. The PATH on the edge of the box is ignored.
     /// \param box_size Size of the chunk. All boxes are squares so the last one might be discarded
-    /// \return Node matrix
-    auto createGrid(structs::DiscreteBox box, std::vector<structs::Node> &drone_path, float sparsity, float box_size, float node_density_coefficient) -> std::vector<std::vector<structs::DiscreteBoxInfo>> {
+    /// \param resource Where the grid and the scratch data of its creation are allocated
+    /// \return The box matrix, with the nodes of every box
+    auto createGrid(structs::DiscreteBox box, const std::vector<std::vector<Coordinate>> &drone_paths, float sparsity, float box_size, float node_density_coefficient, std::pmr::memory_resource *resource) -> structs::TerrainGrid {
         // Calculate the number of boxes in latitude and longitude
         int latBoxes = floor((box.urLat - box.llLat) / box_size);
         int lonBoxes = floor((box.urLon - box.llLon) / box_size);
 
-        std::vector<float> latOptions;
-        std::vector<float> lonOptions;
+        std::pmr::vector<float> latOptions{resource};
+        std::pmr::vector<float> lonOptions{resource};
 
         for (int i = 0; i < latBoxes + 1; i++) {
             latOptions.push_back(box.llLat + i * box_size);
@@ -356,7 +429,9 @@ namespace dfv::map {
             lonOptions.push_back(box.llLon + j * box_size);
         }
 
-        std::vector<std::vector<structs::DiscreteBoxInfo>> box_matrix(latBoxes, std::vector<structs::DiscreteBoxInfo>(lonBoxes));
+        structs::TerrainGrid grid{resource};
+        auto &box_matrix = grid.boxes;
+        box_matrix.assign(latBoxes, std::pmr::vector<structs::DiscreteBoxInfo>(lonBoxes, resource));
 
         // Iterate over each box in the matrix
         for (int i = 0; i < latBoxes; i++) {
@@ -371,19 +446,34 @@ namespace dfv::map {
                 boxInfo.box = {minLat, minLon, maxLat, maxLon};
 
                 boxInfo.is_on_path = false;
-                for (const auto &node : drone_path) {
-                    if (node.lat >= minLat && node.lat <= maxLat &&
-                        node.lon >= minLon && node.lon <= maxLon) {
-                        boxInfo.is_on_path = true;
-                        break; // No need to check further if one node is inside the box
-                    }
-                }
 
                 // Add the boxInfo to the matrix
                 box_matrix[i][j] = boxInfo;
             }
         }
 
+        // Bin the path into the boxes in a single pass: the box of each node is computed from its position, and the boxes
+        // crossed between two nodes are walked too, so that the sparse nodes of a fast flight leave no gaps. Only the nodes
+        // of the same flight are joined, the drone never flew from the end of a flight to the start of the next one
+        const auto mark_on_path = [&](const int i, const int j) {
+            if (i >= 0 && i < latBoxes && j >= 0 && j < lonBoxes)
+                box_matrix[i][j].is_on_path = true;
+        };
+        for (const auto &drone_path : drone_paths) {
+            for (size_t k = 0; k < drone_path.size(); k++) {
+                const double u = (drone_path[k].lat - box.llLat) / box_size;
+                const double v = (drone_path[k].lon - box.llLon) / box_size;
+                if (k == 0) {
+                    mark_on_path(static_cast<int>(std::floor(u)), static_cast<int>(std::floor(v)));
+                    continue;
+                }
+
+                const double previous_u = (drone_path[k - 1].lat - box.llLat) / box_size;
+                const double previous_v = (drone_path[k - 1].lon - box.llLon) / box_size;
+                walkBoxes(previous_u, previous_v, u, v, mark_on_path);
+            }
+        }
+
         // create the 3 block wide high density area. If a box on path is on the edge meh.
         for (int i = 1; i < box_matrix.size() - 1; i++) {
             for (int j = 1; j < box_matrix[0].size() - 1; j++) {
@@ -423,53 +513,7 @@ namespace dfv::map {
             }
         }
 
-        int max_iterations = 1000;
-        int iter = 0;
-        bool no_changes = false;
-        while (!no_changes && iter < max_iterations) {
-            no_changes = true;
-            for (int i = 0; i < box_matrix.size(); i++) {
-                for (int j = 0; j < box_matrix[0].size(); j++) {
-                    int closest = INT_MAX;
-                    bool iter_changes = false;
-                    for (int a = 1; a < box_matrix.size(); a++) {
-                        if (i - a > 0) {
-                            if (box_matrix[i - a][j].distance < closest) {
-                                closest = box_matrix[i - a][j].distance + a;
-                                iter_changes = true;
-                            }
-                        }
-                        if (i + a < box_matrix.size()) {
-                            if (box_matrix[i + a][j].distance < closest) {
-                                closest = box_matrix[i + a][j].distance + a;
-                                iter_changes = true;
-                            }
-                        }
-                        if (j - a > 0) {
-                            if (box_matrix[i][j - a].distance < closest) {
-                                closest = box_matrix[i][j - a].distance + a;
-                                iter_changes = true;
-                            }
-                        }
-                        if (j + a < box_matrix[i].size()) {
-                            if (box_matrix[i][j + a].distance < closest) {
-                                closest = box_matrix[i][j + a].distance + a;
-                                iter_changes = true;
-                            }
-                        }
-                        if (iter_changes) {
-                            break;
-                        }
-                    }
-                    if (box_matrix[i][j].distance <= closest) {
-                        continue;
-                    }
-                    box_matrix[i][j].distance = closest;
-                    no_changes = false;
-                }
-            }
-            iter++;
-        }
+        propagateBoxDistances(box_matrix);
 
         std::cout << "Distance Matrix for each chunk. Lower means closer to drone path" << std::endl;
 
@@ -498,24 +542,25 @@ namespace dfv::map {
             std::cout << ";" << std::endl; // New line at the end of each row
         }
 
-        // Fill the boxes with nodes
-        std::vector<structs::Node *> nodes;
+        // Fill the boxes with nodes, each box appending its grid to the shared arrays. Their final size is known upfront
+        // so that they are allocated once
+        size_t node_count = 0;
+        for (const auto &row : box_matrix) {
+            for (const auto &ibox : row) {
+                const int side = nodesPerSide(ibox.sparsity);
+                node_count += static_cast<size_t>(side) * side;
+            }
+        }
+        grid.points.reserve(node_count);
         for (auto &row : box_matrix) {
             for (auto &ibox : row) {
-                ibox.dots = createGridSlave(ibox.box.llLat, ibox.box.llLon, ibox.box.urLat, ibox.box.urLon, ibox.sparsity);
-                for (auto &irow : ibox.dots) {
-                    for (auto &inode : irow) {
-                        nodes.push_back(&inode);
-
-                        inode.elev = 1600;
-                    }
-                }
+                createGridSlave(ibox, grid.points);
             }
         }
 
-        populateElevation(&nodes);
+        populateElevation(grid.points);
 
-        return box_matrix;
+        return grid;
     }
 
     glm::vec3 calculateTriangleNormal(const Vertex &v1, const Vertex &v2, const Vertex &v3) {
@@ -530,181 +575,173 @@ namespace dfv::map {
         return glm::normalize(normal);
     }
 
-    Mesh createMeshArray(std::vector<std::vector<structs::DiscreteBoxInfo>> &box_matrix, double llLatBound, double llLonBound, double urLatBound, double urLonBound, Coordinate initialPosition) {
+    Mesh createMeshArray(structs::TerrainGrid &grid, double llLatBound, double llLonBound, double urLatBound, double urLonBound, Coordinate initialPosition) {
         double worldLatSpan = urLatBound - llLatBound;
         double worldLonSpan = urLonBound - llLonBound;
         Mesh mesh = {};
         float elevation_scale = 1;
 
+        const auto &box_matrix = grid.boxes;
+        const auto &points = grid.points;
+        const size_t cols = box_matrix[0].size();
+        const size_t box_count = box_matrix.size() * cols;
+        const auto box_at = [&](const size_t b) -> const structs::DiscreteBoxInfo & {
+            return box_matrix[b / cols][b % cols];
+        };
+
+        const auto position_of = [&](const size_t node) -> glm::vec3 {
+            return {static_cast<float>((points.lon[node] - initialPosition.lon) * SCALING_FACTOR),
+                    points.elev[node] * elevation_scale,
+                    static_cast<float>((points.lat[node] - initialPosition.lat) * SCALING_FACTOR)};
+        };
+
         auto start = clock::now();
-        for (int ii = 0; ii < box_matrix.size(); ++ii) {
-            for (int ie = 0; ie < box_matrix[0].size(); ++ie) {
-                structs::DiscreteBoxInfo *box = &box_matrix[ii][ie];
-
-                //create inner box mash
-                for (int i = 0; i < box->dots.size() - 1; ++i) {
-                    for (int e = 0; e < box->dots[0].size() - 1; ++e) {
-                        if (box->dots[i][e].game_node == nullptr) {
-                            box->dots[i][e].game_node = new GameNode();
-                            // box->dots[i][e].game_node->ux = std::max(1.0, (box->dots[i][e].lon - llLonBound) / worldLonSpan);
-                            // box->dots[i][e].game_node->uy = std::min(0.0,1 - (box->dots[i][e].lat - llLatBound) / worldLatSpan);
-                            box->dots[i][e].game_node->x = (box->dots[i][e].lon - initialPosition.lon) * SCALING_FACTOR;
-                            box->dots[i][e].game_node->z = (box->dots[i][e].lat - initialPosition.lat) * SCALING_FACTOR;
-                            box->dots[i][e].game_node->y = box->dots[i][e].elev * elevation_scale;
-                            mesh.vertices.push_back({
-                                    {box->dots[i][e].game_node->x, box->dots[i][e].game_node->y, box->dots[i][e].game_node->z},
-                                    {0.f, 0.f, 0.f},
-                                    {box->dots[i][e].game_node->ux, box->dots[i][e].game_node->uy}
-                            });
-                            box->dots[i][e].game_node->vertex_index = mesh.vertices.size() - 1;
-                        }
-                        if (box->dots[i][e + 1].game_node == nullptr) {
-                            box->dots[i][e + 1].game_node = new GameNode();
-                            // box->dots[i][e + 1].game_node->ux = std::max(1.0,(box->dots[i][e + 1].lon - llLonBound) / worldLonSpan);
-                            // box->dots[i][e + 1].game_node->uy = std::min(0.0,1 - (box->dots[i][e + 1].lat - llLatBound) / worldLatSpan);
-                            box->dots[i][e + 1].game_node->x = (box->dots[i][e + 1].lon - initialPosition.lon) * SCALING_FACTOR;
-                            box->dots[i][e + 1].game_node->z = (box->dots[i][e + 1].lat - initialPosition.lat) * SCALING_FACTOR;
-                            box->dots[i][e + 1].game_node->y = box->dots[i][e + 1].elev * elevation_scale;
-                            mesh.vertices.push_back({
-                                    {box->dots[i][e + 1].game_node->x, box->dots[i][e + 1].game_node->y, box->dots[i][e + 1].game_node->z},
-                                    {0.f, 0.f, 0.f},
-                                    {box->dots[i][e + 1].game_node->ux, box->dots[i][e + 1].game_node->uy}
-                            });
-                            box->dots[i][e + 1].game_node->vertex_index = mesh.vertices.size() - 1;
-                        }
-                        if (box->dots[i + 1][e].game_node == nullptr) {
-                            box->dots[i + 1][e].game_node = new GameNode();
-                            // box->dots[i + 1][e].game_node->ux = std::max(1.0,(box->dots[i + 1][e].lon - llLonBound) / worldLonSpan);
-                            // box->dots[i + 1][e].game_node->uy = std::min(0.0,1 - (box->dots[i + 1][e].lat - llLatBound) / worldLatSpan);
-                            box->dots[i + 1][e].game_node->x = (box->dots[i + 1][e].lon - initialPosition.lon) * SCALING_FACTOR;
-                            box->dots[i + 1][e].game_node->z = (box->dots[i + 1][e].lat - initialPosition.lat) * SCALING_FACTOR;
-                            box->dots[i + 1][e].game_node->y = box->dots[i + 1][e].elev * elevation_scale;
-                            mesh.vertices.push_back({
-                                    {box->dots[i + 1][e].game_node->x, box->dots[i + 1][e].game_node->y, box->dots[i + 1][e].game_node->z},
-                                    {0.f, 0.f, 0.f},
-                                    {box->dots[i + 1][e].game_node->ux, box->dots[i + 1][e].game_node->uy}
-                            });
-                            box->dots[i + 1][e].game_node->vertex_index = mesh.vertices.size() - 1;
-                        }
-
-                        if (i != 0 && i != box->dots.size() - 2 && e != 0 && e != box->dots[0].size() - 2) {
-                            mesh.indices.push_back(box->dots[i][e].game_node->vertex_index);
-                            mesh.indices.push_back(box->dots[i][e + 1].game_node->vertex_index);
-                            mesh.indices.push_back(box->dots[i + 1][e].game_node->vertex_index);
-                        }
-                    }
-                    for (int e = 0; e < box->dots[0].size() - 1; ++e) {
-                        if (box->dots[i + 1][e + 1].game_node == nullptr) {
-                            box->dots[i + 1][e + 1].game_node = new GameNode();
-                            // box->dots[i + 1][e + 1].game_node->ux = std::max(1.0,(box->dots[i + 1][e + 1].lon - llLonBound) / worldLonSpan);
-                            // box->dots[i + 1][e + 1].game_node->uy = std::min(0.0,1 - (box->dots[i + 1][e + 1].lat - llLatBound) / worldLatSpan);
-                            box->dots[i + 1][e + 1].game_node->x = (box->dots[i + 1][e + 1].lon - initialPosition.lon) * SCALING_FACTOR;
-                            box->dots[i + 1][e + 1].game_node->z = (box->dots[i + 1][e + 1].lat - initialPosition.lat) * SCALING_FACTOR;
-                            box->dots[i + 1][e + 1].game_node->y = box->dots[i + 1][e + 1].elev * elevation_scale;
-                            mesh.vertices.push_back({
-                                    {box->dots[i + 1][e + 1].game_node->x, box->dots[i + 1][e + 1].game_node->y, box->dots[i + 1][e + 1].game_node->z},
-                                    {0.f, 0.f, 0.f},
-                                    {box->dots[i + 1][e + 1].game_node->ux, box->dots[i + 1][e + 1].game_node->uy}
-                            });
-                            box->dots[i + 1][e + 1].game_node->vertex_index = mesh.vertices.size() - 1;
-                        }
-                        if (i != 0 && i != box->dots.size() - 2 && e != 0 && e != box->dots[0].size() - 2) {
-                            mesh.indices.push_back(box->dots[i][e + 1].game_node->vertex_index);
-                            mesh.indices.push_back(box->dots[i + 1][e + 1].game_node->vertex_index);
-                            mesh.indices.push_back(box->dots[i + 1][e].game_node->vertex_index);
-                        }
-                    }
-                }
-            }
-        }
 
-        for (int ii = 0; ii < box_matrix.size(); ++ii) {
-            for (int ie = 0; ie < box_matrix[0].size(); ++ie) {
-                structs::DiscreteBoxInfo *box = &box_matrix[ii][ie];
-
-                //Set UVs
-                auto minX = box_matrix[0][0].dots[0][0].game_node->x;
-                auto maxX = box_matrix[0].back().dots[0].back().game_node->x;
-                auto minZ = box_matrix[0][0].dots[0][0].game_node->z;
-                auto maxZ = box_matrix.back()[0].dots.back()[0].game_node->z;
-                //Fill every node with UVs
-                for (auto &row : box->dots) {
-                    for (auto &inode : row) {
-                        inode.game_node->ux = (inode.game_node->x - minX) / (maxX - minX);
-                        inode.game_node->uy = (inode.game_node->z - minZ) / (maxZ - minZ);
-                        mesh.vertices[inode.game_node->vertex_index].uv = {inode.game_node->ux, inode.game_node->uy};
-                    }
+        // Count the indices of the inner triangles of every box, and give each box its range of the index buffer with a
+        // prefix sum. The vertices need no counting: every node is a vertex and the nodes of a box are already contiguous
+        std::pmr::vector<size_t> index_offsets(box_count + 1, 0, grid.resource());
+        for (size_t b = 0; b < box_count; b++) {
+            const auto &box = box_at(b);
+            const size_t inner_rows = std::max(box.rows - 3, 0);
+            const size_t inner_cols = std::max(box.cols - 3, 0);
+            index_offsets[b + 1] = index_offsets[b] + 6 * inner_rows * inner_cols;
+        }
+        mesh.vertices.resize(points.size());
+        mesh.indices.resize(index_offsets[box_count]);
+
+        //Set UVs
+        const auto &last_column_box = box_matrix[0].back();
+        const auto &last_row_box = box_matrix.back()[0];
+        auto minX = position_of(box_matrix[0][0].at(0, 0)).x;
+        auto maxX = position_of(last_column_box.at(0, last_column_box.cols - 1)).x;
+        auto minZ = position_of(box_matrix[0][0].at(0, 0)).z;
+        auto maxZ = position_of(last_row_box.at(last_row_box.rows - 1, 0)).z;
+
+        // Build the boxes on every core, each one writing its vertices and inner triangles straight into its ranges
+        parallelFor(box_count, [&](const size_t b) {
+            const auto &box = box_at(b);
+            for (size_t node = box.first; node < box.at(box.rows, 0); ++node) {
+                const glm::vec3 position = position_of(node);
+                mesh.vertices[node] = {position,
+                                       {0.f, 0.f, 0.f},
+                                       {(position.x - minX) / (maxX - minX), (position.z - minZ) / (maxZ - minZ)}};
+            }
+
+            //create inner box mash, leaving out the outer ring of cells which is sewn to the neighbouring boxes
+            uint32_t *index = mesh.indices.data() + index_offsets[b];
+            for (int i = 1; i < box.rows - 2; ++i) {
+                for (int e = 1; e < box.cols - 2; ++e) {
+                    *index++ = box.at(i, e);
+                    *index++ = box.at(i, e + 1);
+                    *index++ = box.at(i + 1, e);
                 }
+                for (int e = 1; e < box.cols - 2; ++e) {
+                    *index++ = box.at(i, e + 1);
+                    *index++ = box.at(i + 1, e + 1);
+                    *index++ = box.at(i + 1, e);
+                }
+            }
+        });
+
+        // Sew every box to the boxes on its left and on top of it, in parallel blocks of boxes. The number of triangles of
+        // a seam is only known once it is sewn, so each block fills its own list and the lists are appended in order
+        const size_t seam_blocks = (box_count + SEAM_BLOCK_SIZE - 1) / SEAM_BLOCK_SIZE;
+        std::vector<std::vector<uint32_t>> seam_indices(seam_blocks);
+        parallelFor(seam_blocks, [&](const size_t block) {
+            // The arena isn't thread-safe, so the lists of a block come from the heap
+            std::vector<uint32_t> commonNodes;
+            std::vector<uint32_t> aNodes;
+            std::vector<uint32_t> bNodes;
+            auto &indices = seam_indices[block];
+            const auto position = [&](const uint32_t node) -> const glm::vec3 & {
+                return mesh.vertices[node].position;
+            };
+
+            for (size_t box_index = block * SEAM_BLOCK_SIZE; box_index < std::min(box_count, (block + 1) * SEAM_BLOCK_SIZE); box_index++) {
+                const size_t ii = box_index / cols;
+                const size_t ie = box_index % cols;
+                const structs::DiscreteBoxInfo &box = box_matrix[ii][ie];
 
                 //sew left box
                 if (ie > 0) {
-                    std::vector<Node> commonNodes;
-                    std::vector<Node> aNodes;
-                    std::vector<Node> bNodes;
-                    commonNodes.reserve((box_matrix)[ii][ie].dots[0].size() + (box_matrix)[ii][ie - 1].dots[0].size());
-                    for (auto &row : (box_matrix)[ii][ie].dots) {
-                        commonNodes.push_back(row[0]);
+                    const structs::DiscreteBoxInfo &left = box_matrix[ii][ie - 1];
+                    commonNodes.clear();
+                    aNodes.clear();
+                    bNodes.clear();
+                    for (int i = 0; i < box.rows; ++i) {
+                        commonNodes.push_back(box.at(i, 0));
                     }
-                    for (auto &row : (box_matrix)[ii][ie - 1].dots) {
-                        commonNodes.push_back(row.back());
+                    for (int i = 0; i < left.rows; ++i) {
+                        commonNodes.push_back(left.at(i, left.cols - 1));
                     }
-                    std::sort(commonNodes.begin(), commonNodes.end(), [](structs::Node &a, structs::Node &b) {
-                        return a.game_node->z < b.game_node->z;
+                    std::sort(commonNodes.begin(), commonNodes.end(), [&](uint32_t a, uint32_t b) {
+                        return position(a).z < position(b).z;
                     });
-                    for (auto &row : (box_matrix)[ii][ie].dots) {
-                        aNodes.push_back(row[1]);
+                    for (int i = 0; i < box.rows; ++i) {
+                        aNodes.push_back(box.at(i, 1));
                     }
-                    for (auto &row : (box_matrix)[ii][ie - 1].dots) {
-                        bNodes.push_back(row.rbegin()[1]);
+                    for (int i = 0; i < left.rows; ++i) {
+                        bNodes.push_back(left.at(i, left.cols - 2));
                     }
-
-                    if(aNodes[0].game_node->x == commonNodes[0].game_node->x){
-                        throw std::runtime_error("aNodes[0].game_node->x == commonNodes[0].game_node->x in sewing");
+                    if(position(aNodes[0]).x == position(commonNodes[0]).x){
+                        throw std::runtime_error("aNodes[0].x == commonNodes[0].x in sewing");
                     }
-                    if(bNodes[0].game_node->x == commonNodes[0].game_node->x){
-                        throw std::runtime_error("aNodes[0].game_node->x == commonNodes[0].game_node->x in sewing");
+                    if(position(bNodes[0]).x == position(commonNodes[0]).x){
+                        throw std::runtime_error("aNodes[0].x == commonNodes[0].x in sewing");
                     }
 
-                    sewBoxesSlave(commonNodes, aNodes, mesh, 1);
-                    sewBoxesSlave(commonNodes, bNodes, mesh, 1);
+                    sewBoxesSlave(points, mesh.vertices, commonNodes, aNodes, indices, 1);
+                    sewBoxesSlave(points, mesh.vertices, commonNodes, bNodes, indices, 1);
                 }
                 //sew top box
                 if (ii > 0) {
-                    std::vector<Node> commonNodes;
-                    std::vector<Node> aNodes;
-                    std::vector<Node> bNodes;
+                    const structs::DiscreteBoxInfo &top = box_matrix[ii - 1][ie];
+                    commonNodes.clear();
+                    aNodes.clear();
+                    bNodes.clear();
 
-                    commonNodes.reserve((box_matrix)[ii][ie].dots[0].size() + (box_matrix)[ii - 1][ie].dots[0].size());
-                    commonNodes.insert(commonNodes.end(), (box_matrix)[ii][ie].dots[0].begin(), (box_matrix)[ii][ie].dots[0].end());
-                    commonNodes.insert(commonNodes.end(), (box_matrix)[ii - 1][ie].dots.back().begin(), (box_matrix)[ii - 1][ie].dots.back().end());
+                    for (int e = 0; e < box.cols; ++e) {
+                        commonNodes.push_back(box.at(0, e));
+                    }
+                    for (int e = 0; e < top.cols; ++e) {
+                        commonNodes.push_back(top.at(top.rows - 1, e));
+                    }
 
-                    std::sort(commonNodes.begin(), commonNodes.end(), [](structs::Node &a, structs::Node &b) {
-                        return a.game_node->x < b.game_node->x;
+                    std::sort(commonNodes.begin(), commonNodes.end(), [&](uint32_t a, uint32_t b) {
+                        return position(a).x < position(b).x;
                     });
 
-                    aNodes.insert(aNodes.begin(), (box_matrix)[ii][ie].dots[1].begin(), (box_matrix)[ii][ie].dots[1].end());
-                    bNodes.insert(bNodes.begin(), (box_matrix)[ii - 1][ie].dots.rbegin()[1].begin(), (box_matrix)[ii - 1][ie].dots.rbegin()[1].end());
+                    for (int e = 0; e < box.cols; ++e) {
+                        aNodes.push_back(box.at(1, e));
+                    }
+                    for (int e = 0; e < top.cols; ++e) {
+                        bNodes.push_back(top.at(top.rows - 2, e));
+                    }
 
-                    if((box_matrix)[ii][ie].dots[0][0].game_node->z != (box_matrix)[ii - 1][ie].dots.back()[0].game_node->z){
+                    if(position(box.at(0, 0)).z != position(top.at(top.rows - 1, 0)).z){
                         throw std::runtime_error("Detected different starting and ending point for box in sewing");
                     }
 
-                    if(aNodes[0].game_node->z == commonNodes[0].game_node->z){
-                        throw std::runtime_error("aNodes[0].game_node->z == commonNodes[0].game_node->z in sewing");
+                    if(position(aNodes[0]).z == position(commonNodes[0]).z){
+                        throw std::runtime_error("aNodes[0].z == commonNodes[0].z in sewing");
                     }
-                    if(bNodes[0].game_node->z == commonNodes[0].game_node->z){
-                        throw std::runtime_error("aNodes[0].game_node->z == commonNodes[0].game_node->z in sewing");
+                    if(position(bNodes[0]).z == position(commonNodes[0]).z){
+                        throw std::runtime_error("aNodes[0].z == commonNodes[0].z in sewing");
                     }
 
-                    sewBoxesSlave(commonNodes, aNodes, mesh, 0);
-                    sewBoxesSlave(commonNodes, bNodes, mesh, 0);
+                    sewBoxesSlave(points, mesh.vertices, commonNodes, aNodes, indices, 0);
+                    sewBoxesSlave(points, mesh.vertices, commonNodes, bNodes, indices, 0);
                 }
             }
+        });
+
+        for (const auto &indices : seam_indices) {
+            mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
         }
         auto end = clock::now();
         std::cout << "Vertex buffer creation took " << duration_cast<milliseconds>(end - start) << std::endl;
 
-        std::vector<uint32_t> vertex_normal_accumulator(mesh.vertices.size(), 0);
+        std::pmr::vector<uint32_t> vertex_normal_accumulator(mesh.vertices.size(), 0, grid.resource());
 
         std::cout << "Nodes : " << mesh.vertices.size() << " Triangles: " << mesh.indices.size() / 3 << std::endl;
 
@@ -741,13 +778,14 @@ namespace dfv::map {
             v3.normal += normal;
             vertex_normal_accumulator[mesh.indices[i + 2]]++;
             if(v1.normal == glm::vec3{0,0,0} || v2.normal == glm::vec3{0,0,0} || v3.normal == glm::vec3{0,0,0} || isnan(v1.normal).x || isnan(v1.normal).z){
-                std::cout << "error";
+                std::cerr << "Degenerate terrain triangle " << i / 3 << " (vertices " << mesh.indices[i] << ", "
+                          << mesh.indices[i + 1] << ", " << mesh.indices[i + 2] << ")" << std::endl;
             }
         }
 
-        for (int i = 0; i < mesh.indices.size(); i += 1) {
-            if(mesh.vertices[mesh.indices[i]].normal == glm::vec3{0,0,0}){
-                std::cout << "error";
+        for (int i = 0; i < mesh.vertices.size(); ++i) {
+            if(vertex_normal_accumulator[i] > 0 && mesh.vertices[i].normal == glm::vec3{0,0,0}){
+                std::cerr << "Terrain vertex " << i << " has no normal" << std::endl;
             }
         }
 
@@ -760,149 +798,34 @@ namespace dfv::map {
         return mesh;
     }
 
-    std::vector<std::vector<structs::Node>> createGrid(std::vector<structs::DiscreteBox> boxes) {
-        std::vector<std::vector<std::vector<structs::Node>>> allNodes;
-        int i = 0;
-        allNodes.reserve(boxes.size());
-        for (structs::DiscreteBox box : boxes) {
-            allNodes.push_back(createGridSlaveMock(box.llLat, box.llLon, box.urLat, box.urLon));
-        }
-        std::vector<std::vector<structs::Node>> nodesBox;
-        double northernmostcurrent = -100;
-        double lastnorthernmostcurrent = -100;
-        double northernmostupper = +100;
-        while (true) {
-            // find nodes with the highest latitude not yet discovered
-            for (auto &nodesMatrix : allNodes) {
-                for (auto &nodesRows : nodesMatrix) {
-                    if (nodesRows[0].lat > northernmostcurrent && nodesRows[0].lat < northernmostupper) {
-                        northernmostcurrent = nodesRows[0].lat;
-                    }
-                }
-            }
-
-            // exit condition on monotonicity
-            if (lastnorthernmostcurrent == northernmostcurrent)
-                break;
-
-            northernmostupper = northernmostcurrent;
-            northernmostcurrent = -100;
-
-            // collect the rows with the nodes with the highest latitude
-            std::vector<std::vector<structs::Node>> sameLatitudeNodes;
-            for (auto &nodesMatrix : allNodes) {
-                for (auto &nodesRows : nodesMatrix) {
-                    if (nodesRows[0].lat == northernmostupper) {
-                        sameLatitudeNodes.push_back(nodesRows);
-                    }
-                }
-            }
-            auto size = sameLatitudeNodes.size();
-            std::cout << "size: " << size << "\n";
-
-            // merge the rows with the same latitude
-            std::vector<int> sameLatitudeNodesIndexes(sameLatitudeNodes.size(), 0);
-            double lower = -400;
-            std::vector<structs::Node> row;
-            while (true) {
-                double iteration_lower = 400;
-                int lowerEl = -1;
-                for (int j = 0; j < sameLatitudeNodesIndexes.size(); ++j) {
-                    if (sameLatitudeNodes[j].size() > sameLatitudeNodesIndexes[j])
-                        if (sameLatitudeNodes[j][sameLatitudeNodesIndexes[j]].lon < iteration_lower && sameLatitudeNodes[j][sameLatitudeNodesIndexes[j]].lon > lower) {
-                            iteration_lower = sameLatitudeNodes[j][sameLatitudeNodesIndexes[j]].lon;
-                            lowerEl = j;
-                        }
-                }
-                if (iteration_lower == 400)
-                    break;
-                row.push_back(sameLatitudeNodes[lowerEl][sameLatitudeNodesIndexes[lowerEl]]);
-                lower = iteration_lower;
-                sameLatitudeNodesIndexes[lowerEl]++;
-            }
-            nodesBox.push_back(row);
-            lastnorthernmostcurrent = northernmostcurrent;
-        }
-        return nodesBox;
-    }
-
-    std::vector<std::vector<structs::Node>> createGridSlave(float llLat, float llLon, float urLat, float urLon, float sparsity) {
-        std::vector<std::vector<structs::Node>> nodes;
-
-        const double baseDensity = 1.0;
-        float densityScale = std::sqrt(10000.0 / sparsity);
-
-        float latInnerNodes = std::max(0.0, std::floor(baseDensity * densityScale) - 1);
-        float lonInnerNodes = std::max(0.0, std::floor(baseDensity * densityScale) - 1);
-
+    void createGridSlave(structs::DiscreteBoxInfo &box_info, structs::TerrainPoints &points) {
+        const float llLat = box_info.box.llLat;
+        const float llLon = box_info.box.llLon;
+        const float urLat = box_info.box.urLat;
+        const float urLon = box_info.box.urLon;
 
         // Total nodes including corners
-        float latTotalNodes = latInnerNodes + 2;
-        float lonTotalNodes = lonInnerNodes + 2;
+        int latTotalNodes = nodesPerSide(box_info.sparsity);
+        int lonTotalNodes = nodesPerSide(box_info.sparsity);
 
         float latStep = (urLat - llLat) / (latTotalNodes - 1);
         float lonStep = (urLon - llLon) / (lonTotalNodes - 1);
 
-        // Iterate through each grid point and create nodes
+        box_info.first = points.size();
+        box_info.rows = latTotalNodes;
+        box_info.cols = lonTotalNodes;
+
+        // Iterate through each grid point and append it, row by row
         for (int i = 0; i < latTotalNodes; i++) {
-            std::vector<structs::Node> row;
             for (int j = 0; j < lonTotalNodes; j++) {
                 float lat = (i == 0) ? llLat : (i == latTotalNodes - 1) ? urLat
                                                                          : llLat + i * latStep;
                 float lon = (j == 0) ? llLon : (j == lonTotalNodes - 1) ? urLon
                                                                          : llLon + j * lonStep;
 
-                // Create a node and add it to the row
-                structs::Node node{"node", 0, lat, lon, {}}; // Adjust parameters as needed
-                row.push_back(node);
+                points.push_back(lat, lon, 1600);
             }
-            // Add the row to the nodes matrix
-            nodes.push_back(row);
         }
-
-        //std::cout << "Starting block" << std::endl;
-
-        return nodes;
-    }
-
-    std::vector<std::vector<structs::Node>> createGridSlaveMock(float llLat, float llLon, float urLat, float urLon) {
-        std::vector<std::vector<structs::Node>> nodes;
-
-        // Calculate the middle latitude and longitude
-        double midLat = (llLat + urLat) / 2.0;
-        double midLon = (llLon + urLon) / 2.0;
-
-        // Create the corners and middle points directly
-        // Lower-left corner
-        structs::Node llNode("node", -1, llLat, llLon, std::map<std::string, std::string>());
-        // Lower-right corner
-        structs::Node lrNode("node", -1, llLat, urLon, std::map<std::string, std::string>());
-        // Upper-left corner
-        structs::Node ulNode("node", -1, urLat, llLon, std::map<std::string, std::string>());
-        // Upper-right corner
-        structs::Node urNode("node", -1, urLat, urLon, std::map<std::string, std::string>());
-        // Center
-        structs::Node centerNode("node", -1, midLat, midLon, std::map<std::string, std::string>());
-        // Middle points between corners and center
-        structs::Node midLower("node", -1, llLat, midLon, std::map<std::string, std::string>());
-        structs::Node midLeft("node", -1, midLat, llLon, std::map<std::string, std::string>());
-        structs::Node midUpper("node", -1, urLat, midLon, std::map<std::string, std::string>());
-        structs::Node midRight("node", -1, midLat, urLon, std::map<std::string, std::string>());
-
-        // Add the points to the nodes vector
-        nodes.push_back({ulNode, midUpper, urNode}); // Top row
-        nodes.push_back({midLeft, centerNode, midRight}); // Middle row
-        nodes.push_back({llNode, midLower, lrNode}); // Bottom row
-
-        std::cout << "Box: \n";
-        for (const auto &row : nodes) {
-            for (const auto &node : row) {
-                node.display();
-            }
-        }
-        std::cout << "\n\n";
-
-        return nodes;
     }
 
     OsmData fetchOsmData(const std::string &bbox) {
@@ -3,25 +3,23 @@
 #include "flight_data/geo_types.h"
 #include "structs/data_structs.h"
 #include "vulkan/vk_mesh.h"
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace dfv::map {
-    void populateElevation(std::vector<structs::Node *> *nodes);
+    void populateElevation(structs::TerrainPoints &points);
 
     structs::OsmData fetchOsmData(const std::string &bbox);
 
-    std::vector<std::vector<structs::Node>> createGridSlave(float llLat, float llLon, float urLat, float urLon, float sparsity);
+    void createGridSlave(structs::DiscreteBoxInfo &box_info, structs::TerrainPoints &points);
 
-    std::vector<std::vector<structs::Node>> createGridSlaveMock(float llLat, float llLon, float urLat, float urLon);
+    auto createGrid(structs::DiscreteBox box, const std::vector<std::vector<Coordinate>> &drone_paths, float sparsity, float box_size, float node_density_coefficient, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) -> structs::TerrainGrid;
 
-    auto createGrid(structs::DiscreteBox box, std::vector<structs::Node> &drone_path, float sparsity, float box_size, float node_density_coefficient) -> std::vector<std::vector<structs::DiscreteBoxInfo>>;
+    Mesh createMeshArray(structs::TerrainGrid &grid, double llLatBound, double llLonBound, double urLatBound, double urLonBound, Coordinate initialPosition);
 
-    void populateElevation(std::vector<structs::Node> &nodes);
+    void PopulateBatchWithElevationOpenElevation(std::span<const float> lat, std::span<const float> lon, std::span<float> elev);
 
-    Mesh createMeshArray(std::vector<std::vector<structs::DiscreteBoxInfo>> &box_matrix, double llLatBound, double llLonBound, double urLatBound, double urLonBound, Coordinate initialPosition);
-
-    void PopulateBatchWithElevationOpenElevation(std::vector<std::reference_wrapper<structs::Node *>> &nodes);
-
-    void PopulateBatchWithElevationGoogle(std::vector<std::reference_wrapper<structs::Node *>> &nodes, std::string &googleApiKey);
+    void PopulateBatchWithElevationGoogle(std::span<const float> lat, std::span<const float> lon, std::span<float> elev, std::string &googleApiKey);
 } // namespace dfv::map
@@ -2,12 +2,17 @@
 
 #include "chunk_loader.h"
 #include "map/data_fetcher.h"
+#include "utils/arena.h"
 
 namespace dfv {
     void MapManager::startLoad(FlightData &flightData, const bool uniformGrid) {
+        const bool complete = flightData.isLoadComplete();
         const auto bbox = flightData.getBoundingBox();
         const auto initialPos = flightData.getInitialPosition();
 
+        useUniformGrid = uniformGrid;
+        partialLoad = !complete;
+
         if (uniformGrid) {
             constexpr int PointCount = 50;
             constexpr double BboxExpandFactor = 0.05;
@@ -18,6 +23,7 @@ namespace dfv {
                     .urLat = bbox.urLat + BboxExpandFactor,
                     .urLon = bbox.urLon + BboxExpandFactor};
 
+            loadedBox = expandedBbox;
             auto loader = std::make_shared<ChunkLoader>(PointCount, expandedBbox, initialPos);
 
             mapMeshFuture = std::async(std::launch::async, [loader] {
@@ -37,13 +43,26 @@ namespace dfv {
                                              .urLat = bbox.urLat + BOX_OFFSET,
                                              .urLon = bbox.urLon + BOX_OFFSET};
 
-            const auto &dronePath = flightData.getPath();
-            std::vector<structs::Node> pathNodes;
-            pathNodes.reserve(dronePath.size());
-            for (const auto &point : dronePath) {
-                pathNodes.emplace_back(static_cast<double>(point.z) / SCALING_FACTOR + initialPos.lat,
-                                       static_cast<double>(point.x) / SCALING_FACTOR + initialPos.lon,
-                                       static_cast<double>(point.y));
+            loadedBox = {.llLat = box.llLat, .llLon = box.llLon, .urLat = box.urLat, .urLon = box.urLon};
+
+            // The path is only available once the flight data is complete, until then the part loaded so far is sampled
+            constexpr float ProvisionalPathRate = 10.f;
+            std::vector<FlightDataPoint> sampledPath;
+            if (!complete)
+                sampledPath = flightData.resample(flightData.getStartTime(), flightData.getValidUntil(), ProvisionalPathRate);
+
+            // Each flight of the source is a separate path, a flight still loading only has one
+            const size_t flightCount = complete ? flightData.getFlightCount() : 1;
+            std::vector<std::vector<Coordinate>> pathNodes(flightCount);
+            for (size_t flight = 0; flight < flightCount; flight++) {
+                const std::span<const FlightDataPoint> dronePath = complete ? flightData.getFlightPath(flight)
+                                                                            : std::span<const FlightDataPoint>{sampledPath};
+                pathNodes[flight].reserve(dronePath.size());
+                for (const auto &point : dronePath) {
+                    pathNodes[flight].push_back({.lat = static_cast<double>(point.z) / SCALING_FACTOR + initialPos.lat,
+                                                 .lon = static_cast<double>(point.x) / SCALING_FACTOR + initialPos.lon,
+                                                 .alt = static_cast<double>(point.y)});
+                }
             }
 
             mapMeshFuture = std::async(std::launch::async, [box, initialPos, pathNodes = std::move(pathNodes)]() mutable {
@@ -51,13 +70,19 @@ namespace dfv {
                 constexpr float box_size = 0.02; // Example box size
                 constexpr float node_density_coefficient = 0.5; // Example coefficient
 
-                auto boxMatrix = dfv::map::createGrid(box, pathNodes, sparsity, box_size, node_density_coefficient);
-
-                return dfv::map::createMeshArray(boxMatrix,
-                                                 box.llLat,
-                                                 box.llLon,
-                                                 box.urLon,
-                                                 box.urLon, initialPos);
+                // Everything but the mesh is only needed while building it, and is released at once with the arena
+                Arena arena;
+                Mesh mesh;
+                {
+                    auto grid = dfv::map::createGrid(box, pathNodes, sparsity, box_size, node_density_coefficient, &arena);
+
+                    mesh = dfv::map::createMeshArray(grid,
+                                                     box.llLat,
+                                                     box.llLon,
+                                                     box.urLon,
+                                                     box.urLon, initialPos);
+                }
+                return mesh;
             });
 
             FlightBoundingBox fbox = {.llLat = box.llLat,
@@ -73,6 +98,26 @@ namespace dfv {
         }
     }
 
+    void MapManager::extendLoad(FlightData &flightData) {
+        // Each load downloads the elevation and the texture again, so the map is reloaded at most once, when the flight
+        // data completes
+        if (!partialLoad || isLoading() || !flightData.isLoadComplete())
+            return;
+
+        const auto bbox = flightData.getBoundingBox();
+        const bool outgrown = bbox.llLat < loadedBox.llLat || bbox.llLon < loadedBox.llLon ||
+                              bbox.urLat > loadedBox.urLat || bbox.urLon > loadedBox.urLon;
+
+        // The path-based grid depends on the whole path, so it is rebuilt even if the area is still covered
+        partialLoad = false;
+        if (outgrown || !useUniformGrid)
+            startLoad(flightData, useUniformGrid);
+    }
+
+    bool MapManager::isLoading() const {
+        return mapMeshFuture.valid() || mapTextureFuture.valid();
+    }
+
     std::optional<Mesh> MapManager::getMapMesh() {
         using namespace std::chrono_literals;
         if (mapMeshFuture.valid() && mapMeshFuture.wait_for(0ms) == std::future_status::ready) {
@@ -16,6 +16,19 @@ namespace dfv {
          */
         void startLoad(FlightData &flightData, bool uniformGrid = false);
 
+        /**
+         * @brief Reloads the map once the flight data completes, if the map was loaded before it did.
+         * @details The map is reloaded if the complete flight left the area of the current map, or if the map was built
+         * from the path. Meant to be called every frame, it does nothing while a load is in progress or once the map was
+         * loaded from the complete flight data.
+         */
+        void extendLoad(FlightData &flightData);
+
+        /**
+         * @brief Returns whether the mesh or the texture of a load are yet to be returned.
+         */
+        bool isLoading() const;
+
         /**
          * @brief Returns the map mesh if it is ready, or an empty optional otherwise.
          */
@@ -29,5 +42,9 @@ namespace dfv {
       private:
         std::future<Mesh> mapMeshFuture;
         std::future<std::vector<std::byte>> mapTextureFuture;
+
+        bool useUniformGrid{false}; //!< Whether the last load used a uniform grid
+        bool partialLoad{false}; //!< Whether the last load started before the flight data was complete
+        FlightBoundingBox loadedBox{}; //!< The area covered by the last load
     };
 } // namespace dfv
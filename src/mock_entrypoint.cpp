@@ -1,23 +1,75 @@
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string_view>
 
 #include "flight_data/mock_flight_data.h"
+#include "flight_data/synthetic_flight_data.h"
 #include "glfw/glfw.h"
 #include "glfw/glfw_surface.h"
 #include "visualizer.h"
 
 /*
  * The main entrypoint of the mock visualizer.
+ *
+ * Command line usage: mock_visualizer [options]
+ * Options:
+ *   --synthetic: show a generated flight instead of the built-in circle, configured by the options below
+ *   --duration S: the duration of the synthetic flight in seconds
+ *   --rate HZ: the number of samples per second of the synthetic flight
+ *   --extent M: the half-size of the area covered by the synthetic flight in meters
+ *   --altitude M: the cruise altitude of the synthetic flight in meters
+ *   --profile constant|mission|undulating: how the altitude of the synthetic flight changes
+ *   --noise M: the amplitude of the position noise of the synthetic flight in meters
+ *   --seed N: the seed of the synthetic flight
  */
-int main() {
+int main(const int argc, char **argv) {
+    bool synthetic = false;
+    dfv::SyntheticFlightOptions syntheticOptions{};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--synthetic")
+            synthetic = true;
+        else if (arg == "--duration" && hasValue)
+            syntheticOptions.duration = std::strtof(argv[++i], nullptr);
+        else if (arg == "--rate" && hasValue)
+            syntheticOptions.sampleRate = std::strtof(argv[++i], nullptr);
+        else if (arg == "--extent" && hasValue)
+            syntheticOptions.extent = std::strtof(argv[++i], nullptr);
+        else if (arg == "--altitude" && hasValue)
+            syntheticOptions.cruiseAltitude = std::strtof(argv[++i], nullptr);
+        else if (arg == "--noise" && hasValue)
+            syntheticOptions.noise = std::strtof(argv[++i], nullptr);
+        else if (arg == "--seed" && hasValue)
+            syntheticOptions.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--profile" && hasValue) {
+            const std::string_view profile = argv[++i];
+            if (profile == "constant")
+                syntheticOptions.altitudeProfile = dfv::AltitudeProfile::Constant;
+            else if (profile == "undulating")
+                syntheticOptions.altitudeProfile = dfv::AltitudeProfile::Undulating;
+            else
+                syntheticOptions.altitudeProfile = dfv::AltitudeProfile::Mission;
+        } else {
+            std::cout << "Unused argument: '" << arg << "'" << std::endl;
+        }
+    }
+
     // Initialize the flight data object
-    dfv::MockFlightData data{};
+    std::unique_ptr<dfv::FlightData> data;
+    if (synthetic)
+        data = std::make_unique<dfv::SyntheticFlightData>(syntheticOptions);
+    else
+        data = std::make_unique<dfv::MockFlightData>();
 
     // GLFW initialization
     const dfv::raii::Glfw glfw{"Mock Visualizer"};
     dfv::GlfwSurface surface{glfw.window()};
 
     const dfv::VisualizerCreateInfo createInfo{.surface = surface,
-                                               .flightData = data,
+                                               .flightData = *data,
                                                .droneModelPath = "assets/models/monkey_smooth.obj",
                                                .droneScale = 1.f};
 
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+
+#include "flight_data/drone_flight_data.h"
+
+namespace {
+    /**
+     * @brief The statistics of a single flight.
+     */
+    struct FlightStats {
+        std::filesystem::path path;
+        float duration; //!< In seconds
+        float distance; //!< 3D distance travelled in meters
+        float maximumAltitude; //!< In meters
+        float maximumSpeed; //!< 3D speed in m/s
+        dfv::FlightBoundingBox boundingBox;
+        size_t sampleCount;
+        size_t anomalyCount;
+    };
+
+    /**
+     * @brief Loads the flight at the given path and computes its statistics.
+     * @return The statistics, or an empty optional if the flight could not be loaded.
+     */
+    std::optional<FlightStats> analyzeFlight(const std::filesystem::path &path, const dfv::DroneFlightDataOptions &options) {
+        dfv::DroneFlightData data{path, options};
+        if (!data.load())
+            return std::nullopt;
+
+        // The derived channels of every sample are read straight from the columns of the track
+        const dfv::FlightTrack *track = data.getTrack();
+        if (!track || track->empty())
+            return std::nullopt;
+
+        const auto groundSpeeds = track->groundSpeeds();
+        const auto verticalSpeeds = track->verticalSpeeds();
+        float maximumSpeed = 0.f;
+        for (size_t i = 0; i < groundSpeeds.size(); i++)
+            maximumSpeed = std::max(maximumSpeed, std::hypot(groundSpeeds[i], verticalSpeeds[i]));
+
+        return FlightStats{.path = path,
+                           .duration = (data.getEndTime() - data.getStartTime()).count(),
+                           .distance = track->distances().back(),
+                           .maximumAltitude = data.getMaximumAltitude(),
+                           .maximumSpeed = maximumSpeed,
+                           .boundingBox = data.getBoundingBox(),
+                           .sampleCount = track->size(),
+                           .anomalyCount = data.getAnomalies().size()};
+    }
+
+    /**
+     * @brief Writes a CSV field, quoting it if needed.
+     */
+    void writeCsvField(std::ostream &out, const std::string &field) {
+        if (field.find_first_of(",\"\n") == std::string::npos) {
+            out << field;
+            return;
+        }
+
+        out << '"';
+        for (const char c : field) {
+            if (c == '"')
+                out << '"';
+            out << c;
+        }
+        out << '"';
+    }
+
+    void writeCsv(std::ostream &out, const std::vector<FlightStats> &flights) {
+        out << "path,duration_s,distance_m,max_altitude_m,max_speed_mps,min_lat,min_lon,max_lat,max_lon,samples,anomalies\n";
+        out.precision(9);
+        for (const auto &flight : flights) {
+            writeCsvField(out, flight.path.string());
+            out << ',' << flight.duration << ',' << flight.distance << ',' << flight.maximumAltitude << ','
+                << flight.maximumSpeed << ',' << flight.boundingBox.llLat << ',' << flight.boundingBox.llLon << ','
+                << flight.boundingBox.urLat << ',' << flight.boundingBox.urLon << ',' << flight.sampleCount << ','
+                << flight.anomalyCount << '\n';
+        }
+        out.flush();
+    }
+
+    void writeJson(std::ostream &out, const std::vector<FlightStats> &flights) {
+        rapidjson::OStreamWrapper stream{out};
+        rapidjson::PrettyWriter writer{stream};
+
+        writer.StartArray();
+        for (const auto &flight : flights) {
+            writer.StartObject();
+            writer.Key("path");
+            writer.String(flight.path.string().c_str());
+            writer.Key("duration");
+            writer.Double(flight.duration);
+            writer.Key("distance");
+            writer.Double(flight.distance);
+            writer.Key("maxAltitude");
+            writer.Double(flight.maximumAltitude);
+            writer.Key("maxSpeed");
+            writer.Double(flight.maximumSpeed);
+            writer.Key("boundingBox");
+            writer.StartArray();
+            writer.Double(flight.boundingBox.llLat);
+            writer.Double(flight.boundingBox.llLon);
+            writer.Double(flight.boundingBox.urLat);
+            writer.Double(flight.boundingBox.urLon);
+            writer.EndArray();
+            writer.Key("samples");
+            writer.Uint64(flight.sampleCount);
+            writer.Key("anomalies");
+            writer.Uint64(flight.anomalyCount);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        out << std::endl;
+    }
+
+    /**
+     * @brief Returns the CSV files at the given path: the path itself if it is a file, or every CSV in the directory
+     * and its subdirectories, sorted.
+     */
+    std::vector<std::filesystem::path> findLogs(const std::filesystem::path &path) {
+        if (!std::filesystem::is_directory(path))
+            return {path};
+
+        std::vector<std::filesystem::path> logs;
+        for (const auto &entry : std::filesystem::recursive_directory_iterator{path}) {
+            auto extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            if (entry.is_regular_file() && extension == ".csv")
+                logs.push_back(entry.path());
+        }
+        std::sort(logs.begin(), logs.end());
+        return logs;
+    }
+
+    void printUsage() {
+        std::cerr << "Usage: dfv_stats <directory or file> [--format csv|json] [--output FILE] [--threads N] [--no-cache]"
+                  << " [--write-cache]" << std::endl;
+    }
+} // namespace
+
+/*
+ * The entrypoint of the headless flight statistics tool.
+ *
+ * Command line usage: dfv_stats <directory or file> [options]
+ * Options:
+ *   --format csv|json: the format of the report, csv by default
+ *   --output FILE: where to write the report, the standard output by default
+ *   --threads N: the number of flights analyzed at once, all hardware threads by default
+ *   --no-cache: don't use the binary flight cache next to each CSV
+ *   --write-cache: write the binary flight cache of the CSVs without an up-to-date one, existing caches are only read
+ *   by default
+ */
+int main(const int argc, char **argv) {
+    std::optional<std::filesystem::path> input;
+    std::optional<std::filesystem::path> output;
+    bool json = false;
+    unsigned int threadCount = 0;
+    // Loading logs the timing of each step, which would only be noise interleaved across the workers
+    dfv::DroneFlightDataOptions options{.parserThreads = 1, .writeCache = false, .headless = true, .quiet = true};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            const std::string_view format = argv[++i];
+            if (format != "csv" && format != "json") {
+                std::cerr << "Unknown report format: '" << format << "'" << std::endl;
+                printUsage();
+                return 1;
+            }
+            json = format == "json";
+        } else if (arg == "--output" && hasValue) {
+            output = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            const std::string_view count = argv[++i];
+            const auto [end, ec] = std::from_chars(count.data(), count.data() + count.size(), threadCount);
+            if (ec != std::errc{} || end != count.data() + count.size() || threadCount == 0) {
+                std::cerr << "The number of threads must be a positive integer: '" << count << "'" << std::endl;
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--no-cache") {
+            options.useCache = false;
+        } else if (arg == "--write-cache") {
+            options.writeCache = true;
+        } else if (!arg.starts_with("--") && !input) {
+            input = arg;
+        } else {
+            std::cerr << "Unused argument: '" << arg << "'" << std::endl;
+        }
+    }
+
+    if (!input) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> logs;
+    try {
+        logs = findLogs(*input);
+    } catch (const std::filesystem::filesystem_error &e) {
+        std::cerr << "Failed to list flight logs: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (output) {
+        outputFile.open(*output);
+        if (!outputFile) {
+            std::cerr << "Failed to open " << *output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &report = output ? outputFile : std::cout;
+
+    const auto startTime = dfv::clock::now();
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    const size_t workerCount = std::clamp<size_t>(logs.size(), 1, threadCount);
+
+    // Each worker loads one flight at a time on its own thread and releases it before taking the next log, so that
+    // memory is bounded by the largest flights in progress rather than by the size of the directory
+    std::vector<std::optional<FlightStats>> stats(logs.size());
+    std::atomic<size_t> nextLog{0};
+    const auto work = [&] {
+        for (size_t i = nextLog++; i < logs.size(); i = nextLog++)
+            stats[i] = analyzeFlight(logs[i], options);
+    };
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(workerCount);
+    for (size_t worker = 0; worker < workerCount; worker++)
+        workers.push_back(std::async(std::launch::async, work));
+    for (auto &worker : workers)
+        worker.get();
+
+    std::vector<FlightStats> flights;
+    flights.reserve(logs.size());
+    for (size_t i = 0; i < logs.size(); i++) {
+        if (stats[i])
+            flights.push_back(std::move(*stats[i]));
+        else
+            std::cerr << "Skipped flight log " << logs[i] << std::endl;
+    }
+
+    if (json)
+        writeJson(report, flights);
+    else
+        writeCsv(report, flights);
+
+    std::cerr << "Analyzed " << flights.size() << " flights in "
+              << duration_cast<dfv::milliseconds>(dfv::clock::now() - startTime).count() << "ms ("
+              << logs.size() - flights.size() << " skipped, " << workerCount << " workers)" << std::endl;
+    return 0;
+}
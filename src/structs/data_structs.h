@@ -1,39 +1,23 @@
 #pragma once
 
+#include <climits>
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace dfv::structs {
-    struct GameNode {
-        float x;
-        float y;
-        float z = 0;
-        float ux;
-        float uy;
-        unsigned long long vertex_index = -1;
-
-        std::string toString() const {
-            return ("x: " + std::to_string(x) + " y: " + std::to_string(y) + "z: " + std::to_string(z) + " index: " + std::to_string(vertex_index));
-        }
-    };
-
-
     struct Node {
         std::string type;
         int64_t id;
         float lat;
         float lon;
         float elev = 0;
-        GameNode *game_node = nullptr;
         std::map<std::string, std::string> tags;
 
-        Node(float lat, float lon, float elev) :
-              id(0), lat(lat), lon(lon), elev(elev) {}
-
         Node(std::string type, int64_t id, float lat, float lon, std::map<std::string, std::string> tags) :
                 type(std::move(type)), id(id), lat(lat), lon(lon), tags(std::move(tags)) {}
 
@@ -50,12 +34,6 @@ namespace dfv::structs {
         }
     };
 
-    struct Triangle {
-        GameNode *a;
-        GameNode *b;
-        GameNode *c;
-    };
-
     struct DiscreteBox {
         double llLat = 10000;
         double llLon = 10000;
@@ -68,7 +46,57 @@ namespace dfv::structs {
         bool is_on_path;
         float sparsity = 0;
         int distance = INT_MAX;
-        std::vector<std::vector<structs::Node>> dots;
+
+        // The grid of points of the box, stored row by row from its lower latitude in a range of TerrainPoints
+        size_t first = 0; //!< The index of the first point of the box
+        int rows = 0; //!< The number of points along the latitude
+        int cols = 0; //!< The number of points along the longitude, which is also the stride of a row
+
+        /// The index of the point at the given row and column
+        size_t at(int row, int col) const {
+            return first + static_cast<size_t>(row) * cols + col;
+        }
+    };
+
+    /// The points of every terrain box as parallel arrays, indexed by DiscreteBoxInfo::at. Each point is the vertex of
+    /// the terrain mesh with the same index
+    struct TerrainPoints {
+        std::pmr::vector<float> lat;
+        std::pmr::vector<float> lon;
+        std::pmr::vector<float> elev;
+
+        explicit TerrainPoints(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                lat(resource), lon(resource), elev(resource) {}
+
+        size_t size() const {
+            return lat.size();
+        }
+
+        void reserve(size_t count) {
+            lat.reserve(count);
+            lon.reserve(count);
+            elev.reserve(count);
+        }
+
+        void push_back(float point_lat, float point_lon, float point_elev) {
+            lat.push_back(point_lat);
+            lon.push_back(point_lon);
+            elev.push_back(point_elev);
+        }
+    };
+
+    /// The terrain around a drone path: a matrix of boxes, each one a grid of points of its own density
+    struct TerrainGrid {
+        std::pmr::vector<std::pmr::vector<DiscreteBoxInfo>> boxes;
+        TerrainPoints points;
+
+        /// \param resource Where the boxes and points are allocated, usually the arena of a map load
+        explicit TerrainGrid(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                boxes(resource), points(resource) {}
+
+        std::pmr::memory_resource *resource() const {
+            return boxes.get_allocator().resource();
+        }
     };
 
     struct Way {
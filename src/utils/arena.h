@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace dfv {
+    /**
+     * @brief A bump allocator for data that is released all at once, when the arena is destroyed.
+     * @details Allocations are carved out of blocks taken from the heap, each larger than the last, and freeing them does
+     * nothing.
+     * @note Not thread-safe.
+     */
+    class Arena : public std::pmr::memory_resource {
+      public:
+        /**
+         * @param initialSize The size of the first block in bytes.
+         */
+        explicit Arena(const size_t initialSize = 64 * 1024) : blocks(initialSize) {}
+
+        // Disallow copying and moving, containers keep a pointer to the arena
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+      private:
+        void *do_allocate(const size_t size, const size_t alignment) override {
+            return blocks.allocate(size, alignment);
+        }
+
+        void do_deallocate(void *, size_t, size_t) override {}
+
+        bool do_is_equal(const memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::monotonic_buffer_resource blocks;
+    };
+} // namespace dfv
@@ -0,0 +1,132 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX // Disable min and max macros from windows.h
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dfv {
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+        mFileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (mFileHandle == INVALID_HANDLE_VALUE) {
+            mFileHandle = nullptr;
+            throw std::runtime_error("Failed to open file for mapping: " + path.string());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(mFileHandle, &fileSize)) {
+            unmap();
+            throw std::runtime_error("Failed to query file size: " + path.string());
+        }
+
+        // Empty files cannot be mapped, leave the span empty
+        if (fileSize.QuadPart == 0)
+            return;
+
+        mMappingHandle = CreateFileMappingW(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mMappingHandle) {
+            unmap();
+            throw std::runtime_error("Failed to create file mapping: " + path.string());
+        }
+
+        const void *view = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            unmap();
+            throw std::runtime_error("Failed to map view of file: " + path.string());
+        }
+
+        mData = {static_cast<const char *>(view), static_cast<size_t>(fileSize.QuadPart)};
+#else
+        mFd = open(path.c_str(), O_RDONLY);
+        if (mFd < 0)
+            throw std::runtime_error("Failed to open file for mapping: " + path.string());
+
+        struct stat fileStat {};
+        if (fstat(mFd, &fileStat) != 0) {
+            unmap();
+            throw std::runtime_error("Failed to query file size: " + path.string());
+        }
+
+        // Empty files cannot be mapped, leave the span empty
+        if (fileStat.st_size == 0)
+            return;
+
+        void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (view == MAP_FAILED) {
+            unmap();
+            throw std::runtime_error("Failed to map file: " + path.string());
+        }
+
+        // The file is mostly scanned front to back, let the kernel read ahead aggressively
+        madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+        mData = {static_cast<const char *>(view), static_cast<size_t>(fileStat.st_size)};
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : mData(std::exchange(other.mData, {})),
+#ifdef _WIN32
+          mFileHandle(std::exchange(other.mFileHandle, nullptr)),
+          mMappingHandle(std::exchange(other.mMappingHandle, nullptr)) {
+#else
+          mFd(std::exchange(other.mFd, -1)) {
+#endif
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            mData = std::exchange(other.mData, {});
+#ifdef _WIN32
+            mFileHandle = std::exchange(other.mFileHandle, nullptr);
+            mMappingHandle = std::exchange(other.mMappingHandle, nullptr);
+#else
+            mFd = std::exchange(other.mFd, -1);
+#endif
+        }
+        return *this;
+    }
+
+    std::span<const char> MappedFile::data() const {
+        return mData;
+    }
+
+    size_t MappedFile::size() const {
+        return mData.size();
+    }
+
+    void MappedFile::unmap() {
+#ifdef _WIN32
+        if (!mData.empty())
+            UnmapViewOfFile(mData.data());
+        if (mMappingHandle)
+            CloseHandle(mMappingHandle);
+        if (mFileHandle)
+            CloseHandle(mFileHandle);
+        mMappingHandle = nullptr;
+        mFileHandle = nullptr;
+#else
+        if (!mData.empty())
+            munmap(const_cast<char *>(mData.data()), mData.size());
+        if (mFd >= 0)
+            close(mFd);
+        mFd = -1;
+#endif
+        mData = {};
+    }
+} // namespace dfv
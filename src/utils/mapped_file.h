@@ -0,0 +1,47 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+namespace dfv {
+    /**
+     * @brief A read-only memory mapping of a whole file.
+     * @details The mapping is released when the object is destroyed, any span returned by data() must not outlive it.
+     */
+    class MappedFile {
+      public:
+        /**
+         * @brief Maps the file at the given path into memory.
+         * @param path The path to the file to map.
+         * @note Throws std::runtime_error if the file cannot be opened or mapped.
+         */
+        explicit MappedFile(const std::filesystem::path &path);
+
+        ~MappedFile();
+
+        // Disallow copying
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        // Allow moving
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        /**
+         * @return A span of the mapped file contents, empty if the file is empty.
+         */
+        std::span<const char> data() const;
+
+        size_t size() const;
+
+      private:
+        void unmap();
+
+        std::span<const char> mData{};
+#ifdef _WIN32
+        void *mFileHandle{nullptr};
+        void *mMappingHandle{nullptr};
+#else
+        int mFd{-1};
+#endif
+    };
+} // namespace dfv
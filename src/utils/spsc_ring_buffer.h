@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace dfv {
+    /**
+     * @brief A bounded lock-free queue for exactly one producer thread and one consumer thread.
+     * @details Slots are indexed by ever-increasing read and write counters masked to a power-of-two capacity. Each side
+     * keeps a cached copy of the other side's counter, so the shared counters are only read when the queue looks full
+     * (producer) or empty (consumer).
+     */
+    template<typename T>
+    class SpscRingBuffer {
+      public:
+        /**
+         * @param capacity The minimum number of elements the buffer can hold, rounded up to a power of two.
+         */
+        explicit SpscRingBuffer(const size_t capacity)
+            : slots(std::bit_ceil(std::max<size_t>(capacity, 2))), mask(slots.size() - 1) {}
+
+        // Disallow copying and moving, the counters are shared between threads
+        SpscRingBuffer(const SpscRingBuffer &) = delete;
+        SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+        /**
+         * @brief Pushes a value to the back of the queue, must only be called by the producer.
+         * @return True if the value was pushed, false if the queue was full.
+         */
+        bool push(const T &value) {
+            const size_t write = writeIndex.load(std::memory_order_relaxed);
+            if (write - cachedReadIndex == slots.size()) {
+                cachedReadIndex = readIndex.load(std::memory_order_acquire);
+                if (write - cachedReadIndex == slots.size())
+                    return false;
+            }
+
+            slots[write & mask] = value;
+            writeIndex.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Pops as many values as available from the front of the queue, up to the size of the output span.
+         * @details Must only be called by the consumer.
+         * @return The number of values written to the output span.
+         */
+        size_t pop(std::span<T> values) {
+            const size_t read = readIndex.load(std::memory_order_relaxed);
+            if (cachedWriteIndex - read < values.size())
+                cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+
+            const size_t count = std::min(cachedWriteIndex - read, values.size());
+            for (size_t i = 0; i < count; i++)
+                values[i] = slots[(read + i) & mask];
+
+            readIndex.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        size_t capacity() const {
+            return slots.size();
+        }
+
+      private:
+        static constexpr size_t CacheLineSize = 64;
+
+        std::vector<T> slots;
+        const size_t mask;
+
+        // The counters written by each side live on their own cache line, so that the two threads don't false share
+        alignas(CacheLineSize) std::atomic<size_t> writeIndex{0};
+        size_t cachedReadIndex{0}; //!< The producer's last known value of readIndex
+        alignas(CacheLineSize) std::atomic<size_t> readIndex{0};
+        size_t cachedWriteIndex{0}; //!< The consumer's last known value of writeIndex
+    };
+} // namespace dfv
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace dfv {
+    /**
+     * @brief Returns a path next to the given one to write a temporary file to, before renaming it over the target.
+     * @details The name ends in a random number, with an engine per thread seeded differently in every process, so that
+     * concurrent writers of the same target, in this process or another, each write their own file.
+     */
+    inline std::filesystem::path uniqueTempPath(const std::filesystem::path &target) {
+        thread_local std::mt19937_64 engine{std::random_device{}()};
+        const uint64_t suffix = std::uniform_int_distribution<uint64_t>{}(engine);
+        return std::filesystem::path{target} += "." + std::to_string(suffix) + ".tmp";
+    }
+} // namespace dfv
@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <format>
+#include <iostream>
 
 #include "visualizer.h"
+#include <flight_data/anomaly_scanner.h>
+#include <flight_data/telemetry_store.h>
 #include <map/map_manager.h>
 
 #include <glm/gtx/transform.hpp>
@@ -58,12 +63,20 @@ namespace dfv {
     }
 
     void Visualizer::setObjectTransform(const glm::vec3 &position, const glm::vec3 &attitude) {
-        const auto drone = engine.getRenderObject(droneRenderHandle);
-        drone->transform = glm::translate(position) *
-                           glm::rotate(attitude.x, glm::vec3{0.f, 1.f, 0.f}) * // yaw
-                           glm::rotate(attitude.y, glm::vec3{1.f, 0.f, 0.f}) * // pitch
-                           glm::rotate(attitude.z, glm::vec3{0.f, 0.f, 1.f}) * // roll
-                           glm::scale(glm::vec3{droneScale});
+        engine.getRenderObject(droneRenderHandle)->transform = objectTransform(position, attitude);
+    }
+
+    void Visualizer::setObjectTransform(const glm::vec3 &position, const glm::quat &attitude) {
+        engine.getRenderObject(droneRenderHandle)->transform = glm::translate(position) * glm::mat4_cast(attitude) *
+                                                               glm::scale(glm::vec3{droneScale});
+    }
+
+    glm::mat4 Visualizer::objectTransform(const glm::vec3 &position, const glm::vec3 &attitude) const {
+        return glm::translate(position) *
+               glm::rotate(attitude.x, glm::vec3{0.f, 1.f, 0.f}) * // yaw
+               glm::rotate(attitude.y, glm::vec3{1.f, 0.f, 0.f}) * // pitch
+               glm::rotate(attitude.z, glm::vec3{0.f, 0.f, 1.f}) * // roll
+               glm::scale(glm::vec3{droneScale});
     }
 
     void Visualizer::setCameraMovement(const CameraMovement &movement) {
@@ -118,32 +131,83 @@ namespace dfv {
                   .transform = glm::mat4{1.f}};
 
         droneRenderHandle = droneHandle;
+
+        // The other flights of the data source share the drone model
+        for (size_t flight = 1; flight < flightData.getFlightCount(); flight++) {
+            auto [companion, companionHandle] = engine.allocateRenderObject();
+            *companion = {.mesh = droneMesh,
+                          .material = engine.getMaterial("drone"),
+                          .transform = glm::mat4{1.f}};
+
+            companionRenderHandles.push_back(companionHandle);
+        }
+        companionCursors.resize(companionRenderHandles.size());
     }
 
     static bool IsMapMeshLoaded = false;
     static bool IsMapTexLoaded = false;
 
     void Visualizer::update(const seconds_f deltaTime) {
-        time += deltaTime * timeMultiplier;
+        flightData.update();
 
-        auto point = flightData.getPoint(time);
-        setObjectTransform(glm::vec3{point.x, point.y, point.z},
-                           glm::vec3{point.yaw, point.pitch, point.roll});
+        time += deltaTime * timeMultiplier;
+        // Hold the playback at the end of the part of the flight loaded so far
+        if (!flightData.isLoadComplete())
+            time = std::min(time, flightData.getValidUntil());
+
+        updateDistanceIndex();
+        // Anomalies are only scanned once the flight is fully loaded
+        if (!anomalyIndex && flightData.isLoadComplete())
+            anomalyIndex.emplace(flightData.getAnomalies());
+
+        auto point = flightData.getPoint(time, playbackCursor);
+        const auto pose = flightData.getPose(time, playbackCursor);
+        const auto channels = flightData.getChannels(time, playbackCursor);
+
+        // The drone and the camera follow the smooth pose, the UI shows the logged attitude angles
+        point.x = pose.x;
+        point.y = pose.y;
+        point.z = pose.z;
+        setObjectTransform(glm::vec3{pose.x, pose.y, pose.z}, glm::quat{pose.qw, pose.qx, pose.qy, pose.qz});
+
+        for (size_t i = 0; i < companionRenderHandles.size(); i++) {
+            const auto companionPoint = flightData.getFlightPoint(i + 1, time, companionCursors[i]);
+            engine.getRenderObject(companionRenderHandles[i])->transform =
+                    objectTransform(glm::vec3{companionPoint.x, companionPoint.y, companionPoint.z},
+                                    glm::vec3{companionPoint.yaw, companionPoint.pitch, companionPoint.roll});
+        }
 
         static RenderHandle sMapHandle{NullHandle};
+        // A reloaded map, kept aside until its texture is ready
+        static std::optional<Mesh> sPendingMapMesh;
+
+        // Reload the map once the flight data completes, if it was loaded before
+        mapManager.extendLoad(flightData);
 
         // Try to add the map to the engine if it's ready
         auto meshOpt = mapManager.getMapMesh();
         if (meshOpt) {
-            auto [mapObject, mapHandle] = engine.allocateRenderObject();
-            *mapObject = {.mesh = engine.insertMesh("map", std::move(*meshOpt)),
-                          .material = engine.getMaterial("map_simple"),
-                          .transform = glm::mat4{1.f}};
-            sMapHandle = mapHandle;
-            IsMapMeshLoaded = true;
+            if (sMapHandle == NullHandle) {
+                sMapHandle = engine.allocateRenderObject().handle;
+                *engine.getRenderObject(sMapHandle) = {.mesh = engine.insertMesh("map", std::move(*meshOpt)),
+                                                       .material = engine.getMaterial("map_simple"),
+                                                       .transform = glm::mat4{1.f}};
+                IsMapMeshLoaded = true;
+            } else {
+                // The previous map stays on screen, textured, until the reloaded one can replace it with its texture
+                sPendingMapMesh = std::move(*meshOpt);
+            }
         }
 
         auto textureOpt = mapManager.getMapTexture();
+        if (sPendingMapMesh && (textureOpt || !mapManager.isLoading())) {
+            // Without a texture, the reloaded map is shown untextured
+            *engine.getRenderObject(sMapHandle) = {.mesh = engine.insertMesh("map", std::move(*sPendingMapMesh)),
+                                                   .material = engine.getMaterial("map_simple"),
+                                                   .transform = glm::mat4{1.f}};
+            sPendingMapMesh.reset();
+            IsMapTexLoaded = false;
+        }
         if (textureOpt) {
             const auto texture = engine.insertTexture("map", *textureOpt, true);
             engine.applyTexture(sMapHandle, texture, engine.getMaterial("map_textured"));
@@ -153,7 +217,7 @@ namespace dfv {
         // Update camera
         updateCamera(deltaTime, point);
 
-        updateUi(point);
+        updateUi(point, channels);
 
         // Run user-defined updates
         onUpdate(deltaTime);
@@ -247,7 +311,7 @@ namespace dfv {
         }
     }
 
-    void Visualizer::updateUi(const FlightDataPoint &dataPoint) {
+    void Visualizer::updateUi(const FlightDataPoint &dataPoint, const DerivedChannels &channels) {
         engine.submitUi([&] {
             // Last 100 altitude values for plotting
             static std::array<float, 1000> values = {};
@@ -273,10 +337,23 @@ namespace dfv {
             if (ImGui::Begin("Overlay", nullptr, overlayFlags)) {
                 ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
                 ImGui::Text("Timestamp: %.3fs", time.count());
+                if (!flightData.isLoadComplete())
+                    ImGui::Text("Loaded up to: %.3fs", flightData.getValidUntil().count());
 
                 ImGui::SeparatorText("Drone");
                 ImGui::Text("X: %8.2f  Y: %8.2f  Z: %8.2f", dataPoint.x, dataPoint.y, dataPoint.z);
                 ImGui::Text("Y: %8.2f  P: %8.2f  R: %8.2f", glm::degrees(dataPoint.yaw), glm::degrees(dataPoint.pitch), glm::degrees(dataPoint.roll));
+                ImGui::Text("Ground speed: %6.2fm/s  Vertical speed: %6.2fm/s", channels.groundSpeed, channels.verticalSpeed);
+                ImGui::Text("Acceleration: %6.2fm/s2  Heading rate: %6.2fdeg/s", channels.acceleration, glm::degrees(channels.headingRate));
+                ImGui::Text("Distance: %.1fm", channels.distance);
+
+                for (size_t flight = 1; flight < flightData.getFlightCount(); flight++) {
+                    if (const auto deviation = flightData.getFlightDeviation(flight, time))
+                        ImGui::Text("Flight %zu deviation: %.1fm", flight + 1, *deviation);
+                }
+
+                if (const FlightAnomaly *active = anomalyIndex ? anomalyIndex->activeAt(time.count()) : nullptr)
+                    ImGui::Text("Anomaly: %s (peak %.2f)", anomalyName(active->type).data(), active->peak);
 
                 ImGui::SeparatorText("Camera");
                 ImGui::Text("X: %8.2f  Y: %8.2f  X: %8.2f", engine.camera.position.x, engine.camera.position.y, engine.camera.position.z);
@@ -290,6 +367,45 @@ namespace dfv {
                 std::string altitude = std::format("{:.2f}m", dataPoint.y);
                 ImGui::PlotLines(altitude.c_str(), values.data(), values.size(), valuesOffset, "Altitude (m)",
                                  flightData.getMinimumAltitude(), flightData.getMaximumAltitude(), ImVec2(0, 80.0f));
+
+                TelemetryStore *telemetry = flightData.getTelemetry();
+                if (telemetry && telemetry->rowCount() > 0) {
+                    if (ImGui::BeginCombo("Telemetry", telemetryColumn.empty() ? "None" : telemetryColumn.c_str())) {
+                        if (ImGui::Selectable("None", telemetryColumn.empty()))
+                            telemetryColumn.clear();
+                        const auto &names = telemetry->columnNames();
+                        for (size_t i = 0; i < names.size(); i++) {
+                            ImGui::PushID(static_cast<int>(i));
+                            if (ImGui::Selectable(names[i].c_str(), names[i] == telemetryColumn))
+                                telemetryColumn = names[i];
+                            ImGui::PopID();
+                        }
+                        ImGui::EndCombo();
+                    }
+
+                    if (!telemetryColumn.empty()) {
+                        // The column is decoded in the background the first time it is selected, as is the time column
+                        const TelemetryColumn *column = telemetry->tryColumn(telemetryColumn);
+                        const std::optional<size_t> row = telemetry->rowAt(time.count());
+                        if (!column || !row) {
+                            ImGui::Text("Decoding...");
+                        } else if (std::isnan(column->minimum)) {
+                            ImGui::Text("No numeric values");
+                        } else {
+                            // Gaps are drawn at the bottom of the plot rather than as NaN
+                            const auto getter = [](void *data, const int index) {
+                                const auto &plotted = *static_cast<const TelemetryColumn *>(data);
+                                const float value = plotted.values[index];
+                                return std::isnan(value) ? plotted.minimum : value;
+                            };
+                            const float value = column->values[*row];
+                            std::string current = std::format("{:.2f}", value);
+                            ImGui::PlotLines(current.c_str(), getter, const_cast<TelemetryColumn *>(column),
+                                             static_cast<int>(column->values.size()), 0, telemetryColumn.c_str(),
+                                             column->minimum, column->maximum, ImVec2(0, 80.0f));
+                        }
+                    }
+                }
             }
             ImGui::End();
 
@@ -353,6 +469,19 @@ namespace dfv {
             // Multiplier text
             ImGui::Text("x%.1f", timeMultiplier);
 
+            if (!flightData.getAnomalies().empty()) {
+                ImGui::SameLine();
+                ImGui::Text("|");
+
+                ImGui::SameLine();
+                if (ImGui::Button("< Anomaly"))
+                    seekToPreviousAnomaly();
+
+                ImGui::SameLine();
+                if (ImGui::Button("Anomaly >"))
+                    seekToNextAnomaly();
+            }
+
             ImGui::SameLine();
             ImGui::Text("  Camera:");
 
@@ -379,10 +508,61 @@ namespace dfv {
             if (ImGui::Button("Recenter"))
                 recenterCamera();
 
+            // Seek by distance along the path
+            if (distanceIndex && !distanceIndex->empty()) {
+                float kilometers = distanceIndex->distanceAt(time.count()) / 1000.f;
+                ImGui::SetNextItemWidth(ImGui::GetWindowWidth() - ImGui::CalcTextSize("Distance").x - padding);
+                if (ImGui::SliderFloat("Distance", &kilometers, 0.f, distanceIndex->totalDistance() / 1000.f, "%.2f km"))
+                    seekToDistance(kilometers * 1000.f);
+            }
+
             ImGui::End();
         });
     }
 
+    void Visualizer::updateDistanceIndex() {
+        // The path is only complete once the data source is fully loaded
+        if (distanceIndex || !flightData.isLoadComplete())
+            return;
+
+        // The path of a multi-flight source chains unrelated flights, the distance along it means nothing
+        if (flightData.getFlightCount() != 1) {
+            distanceIndex.emplace();
+            return;
+        }
+
+        // The distances of the track are reused when the source keeps one, otherwise they are computed from every sample
+        const auto startTime = clock::now();
+        if (const FlightTrack *track = flightData.getTrack())
+            distanceIndex.emplace(*track);
+        else
+            distanceIndex.emplace(flightData.decodePath(), flightData.getInitialPosition().lat);
+        std::cout << "Distance index built in " << duration_cast<milliseconds>(clock::now() - startTime).count() << "ms ("
+                  << distanceIndex->totalDistance() / 1000.f << "km)" << std::endl;
+    }
+
+    void Visualizer::seekToDistance(const float distance) {
+        if (!distanceIndex || distanceIndex->empty())
+            return;
+        time = seconds_f{distanceIndex->timestampAt(distance)};
+    }
+
+    void Visualizer::seekToNextAnomaly() {
+        const auto anomalies = flightData.getAnomalies();
+        const auto next = std::upper_bound(anomalies.begin(), anomalies.end(), time.count(),
+                                           [](const float t, const FlightAnomaly &anomaly) { return t < anomaly.startTime; });
+        if (next != anomalies.end())
+            time = seconds_f{next->startTime};
+    }
+
+    void Visualizer::seekToPreviousAnomaly() {
+        const auto anomalies = flightData.getAnomalies();
+        const auto previous = std::lower_bound(anomalies.begin(), anomalies.end(), time.count(),
+                                               [](const FlightAnomaly &anomaly, const float t) { return anomaly.startTime < t; });
+        if (previous != anomalies.begin())
+            time = seconds_f{std::prev(previous)->startTime};
+    }
+
     void Visualizer::changeTimeMultiplier(const float multiplier) {
         timeMultiplier = multiplier;
     }
@@ -1,7 +1,13 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
+#include <string>
 
+#include <glm/gtc/quaternion.hpp>
+
+#include "flight_data/anomaly_scanner.h"
+#include "flight_data/distance_index.h"
 #include "flight_data/flight_data.h"
 #include "vulkan/surface_wrapper.h"
 #include "vulkan/vk_engine.h"
@@ -112,6 +118,23 @@ namespace dfv {
          */
         void addToTimeMultiplier(float addend = 2.f);
 
+        /**
+         * @brief Moves the visualization to the time the given distance along the flight path is reached.
+         * @param distance The distance from the start of the path in meters, clamped to the path.
+         * @details Does nothing until the data source is fully loaded, or for data sources with multiple flights.
+         */
+        void seekToDistance(float distance);
+
+        /**
+         * @brief Moves the visualization to the start of the first anomaly starting after the current time, if any.
+         */
+        void seekToNextAnomaly();
+
+        /**
+         * @brief Moves the visualization to the start of the last anomaly starting before the current time, if any.
+         */
+        void seekToPreviousAnomaly();
+
       protected:
         /**
          * @brief Performs user-defined start-up operations
@@ -131,6 +154,18 @@ namespace dfv {
          */
         void setObjectTransform(const glm::vec3 &position, const glm::vec3 &attitude);
 
+        /**
+         * @brief Sets the new position and attitude of the flying object.
+         * @param position x, y, z coordinates of the flying object.
+         * @param attitude The attitude of the flying object as a unit quaternion.
+         */
+        void setObjectTransform(const glm::vec3 &position, const glm::quat &attitude);
+
+        /**
+         * @brief Returns the transform of a flying object at the given position and attitude.
+         */
+        glm::mat4 objectTransform(const glm::vec3 &position, const glm::vec3 &attitude) const;
+
         FlightData &flightData; //!< The data source to visualize
 
       private:
@@ -154,8 +189,15 @@ namespace dfv {
 
         /**
          * @brief Updates the UI of the visualizer.
+         * @param dataPoint The current flight data point.
+         * @param channels The channels derived from the flight data at the current point.
+         */
+        void updateUi(const FlightDataPoint &dataPoint, const DerivedChannels &channels);
+
+        /**
+         * @brief Builds the distance index once the data source is fully loaded.
          */
-        void updateUi(const FlightDataPoint &dataPoint);
+        void updateDistanceIndex();
 
         SurfaceWrapper &surface; //!< The surface to render to
         VulkanEngine engine; //!< The engine that handles rendering
@@ -169,9 +211,15 @@ namespace dfv {
         std::filesystem::path droneModelPath; //!< The path to the flying object 3D model
         float droneScale; //!< The scale of the flying object model
         RenderHandle droneRenderHandle{}; //!< The render handle of the flying object
+        std::vector<RenderHandle> companionRenderHandles; //!< The render handles of the other flights of the data source
 
         seconds_f time{0}; //!< The current time of the visualization
+        PlaybackCursor playbackCursor{}; //!< Where the last lookup of the drone position landed in the flight data
+        std::vector<PlaybackCursor> companionCursors; //!< The playback cursors of the other flights of the data source
         float timeMultiplier{1.f}; //!< A multiplier used during the update of the time of the visualization
+        std::optional<DistanceIndex> distanceIndex; //!< The distance along the flight path, for seeking by distance
+        std::optional<AnomalyIndex> anomalyIndex; //!< Finds the anomaly shown during playback once the flight is loaded
+        std::string telemetryColumn; //!< The telemetry column plotted in the UI, empty for none
 
         Stats stats{}; //!< The statistics of the visualizer
     };
@@ -8,6 +8,7 @@ namespace dfv {
 
     struct Material {
         VkDescriptorSet textureSet{VK_NULL_HANDLE};
+        VkSampler textureSampler{VK_NULL_HANDLE};
         VkPipeline pipeline{VK_NULL_HANDLE};
         VkPipelineLayout pipelineLayout{VK_NULL_HANDLE};
     };
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <ranges>
 
 #include <backends/imgui_impl_vulkan.h>
 #include <imgui.h>
@@ -65,6 +66,9 @@ namespace dfv {
         VK_CHECK(vkWaitForFences(device, 1, &frame.renderFence, true, 1000000000));
         VK_CHECK(vkResetFences(device, 1, &frame.renderFence));
 
+        // The frame has finished rendering, so the objects retired after it was submitted can no longer be in use
+        frame.deletionQueue.flush();
+
         // Request an image from the swapchain, 1 second timeout
         uint32_t swapchainImageIndex;
         VK_CHECK(vkAcquireNextImageKHR(device, swapchain, 1000000000, frame.presentSemaphore, nullptr, &swapchainImageIndex));
@@ -256,6 +260,21 @@ namespace dfv {
         surfaceWrap.destroyImgui();
         ImGui::DestroyContext();
 
+        for (auto &frame : frames)
+            frame.deletionQueue.flush();
+
+        // Meshes, textures and samplers can be replaced while running, so those still in use are only known now
+        for (const auto &mesh : meshes | std::views::values) {
+            vmaDestroyBuffer(allocator, mesh.vertexBuffer.buffer, mesh.vertexBuffer.allocation);
+            vmaDestroyBuffer(allocator, mesh.indexBuffer.buffer, mesh.indexBuffer.allocation);
+        }
+        for (const auto &texture : textures | std::views::values) {
+            vkDestroyImageView(device, texture.imageView, nullptr);
+            vmaDestroyImage(allocator, texture.image.image, texture.image.allocation);
+        }
+        for (const auto &material : materials | std::views::values)
+            vkDestroySampler(device, material.textureSampler, nullptr);
+
         mainDeletionQueue.flush();
         swapchainDeletionQueue.flush();
 
@@ -36,6 +36,8 @@ namespace dfv {
 
         AllocatedBuffer objectBuffer;
         VkDescriptorSet objectDescriptor{VK_NULL_HANDLE};
+
+        DeletionQueue deletionQueue; //!< Objects retired after the frame was submitted, deleted once it has finished rendering
     };
 
     /**
@@ -99,6 +101,7 @@ namespace dfv {
 
         /**
          * Inserts an already loaded mesh into the engine.
+         * A mesh with the same name is replaced, its buffers are deleted once no frame in flight can draw it.
          * @param name The name of the mesh, used to identify it later.
          * @param mesh The mesh to insert.
          * @return A pointer to the inserted mesh.
@@ -123,6 +126,7 @@ namespace dfv {
         /**
          * Inserts a texture from existing data into the engine.
          * Currently only the R8G8B8A8 format is supported.
+         * A texture with the same name is replaced, its image is deleted once no frame in flight can sample it.
          * @param name The name of the texture, used to identify it later.
          * @param data A span of the pixel data to use for the texture.
          * @param decode Whether to decode the texture data from encoded formats.
@@ -247,6 +251,22 @@ namespace dfv {
          */
         void uploadMesh(Mesh &mesh);
 
+        /**
+         * Deletes an object once no frame in flight can use it anymore.
+         * @param function The function deleting the object.
+         */
+        void retireObject(DeletionQueue::DeletionFunc &&function);
+
+        /**
+         * Deletes the GPU buffers of the given mesh once no frame in flight can draw it.
+         */
+        void retireMesh(const Mesh &mesh);
+
+        /**
+         * Deletes the GPU image of the given texture once no frame in flight can sample it.
+         */
+        void retireTexture(const Texture &texture);
+
         /**
          * Uploads the given texture to the GPU.
          * @param texture The texture to upload.
@@ -146,11 +146,6 @@ namespace dfv {
             vkCmdCopyBuffer(cmd, stagingBuffer.buffer, mesh.indexBuffer.buffer, 1, &indexCopy);
         });
 
-        mainDeletionQueue.pushFunction([=, this] {
-            vmaDestroyBuffer(allocator, mesh.vertexBuffer.buffer, mesh.vertexBuffer.allocation);
-            vmaDestroyBuffer(allocator, mesh.indexBuffer.buffer, mesh.indexBuffer.allocation);
-        });
-
         // Immediately destroy the staging buffer
         vmaDestroyBuffer(allocator, stagingBuffer.buffer, stagingBuffer.allocation);
     }
@@ -220,11 +215,6 @@ namespace dfv {
         const VkImageViewCreateInfo viewInfo = vkinit::imageview_create_info(texture.format, texture.image.image, VK_IMAGE_ASPECT_COLOR_BIT);
         VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &texture.imageView));
 
-        mainDeletionQueue.pushFunction([=, this] {
-            vkDestroyImageView(device, texture.imageView, nullptr);
-            vmaDestroyImage(allocator, texture.image.image, texture.image.allocation);
-        });
-
         // Immediately destroy the staging buffer
         vmaDestroyBuffer(allocator, stagingBuffer.buffer, stagingBuffer.allocation);
     }
@@ -254,18 +244,20 @@ namespace dfv {
         if (!meshOpt.has_value())
             return nullptr;
 
-        auto [meshIt, isNewInsertion] = meshes.insert_or_assign(name, std::move(meshOpt.value()));
-        if (!isNewInsertion)
+        if (const auto it = meshes.find(name); it != meshes.end()) {
             std::cerr << "Warning: mesh '" << name << "' was overwritten" << std::endl;
+            retireMesh(it->second);
+        }
+        auto meshIt = meshes.insert_or_assign(name, std::move(meshOpt.value())).first;
 
         uploadMesh(meshIt->second);
         return &meshIt->second;
     }
 
     Mesh *VulkanEngine::insertMesh(const std::string &name, Mesh &&mesh) {
-        auto [meshIt, isNewInsertion] = meshes.insert_or_assign(name, std::move(mesh));
-        if (!isNewInsertion)
-            std::cerr << "Warning: mesh '" << name << "' was overwritten" << std::endl;
+        if (const auto it = meshes.find(name); it != meshes.end())
+            retireMesh(it->second);
+        auto meshIt = meshes.insert_or_assign(name, std::move(mesh)).first;
 
         uploadMesh(meshIt->second);
         return &meshIt->second;
@@ -290,9 +282,11 @@ namespace dfv {
         };
         uploadTexture(texture, loader.data());
 
-        auto [textureIt, isNewInsertion] = textures.insert_or_assign(name, texture);
-        if (!isNewInsertion)
+        if (const auto it = textures.find(name); it != textures.end()) {
             std::cerr << "Warning: texture '" << name << "' was overwritten" << std::endl;
+            retireTexture(it->second);
+        }
+        auto textureIt = textures.insert_or_assign(name, texture).first;
 
         return &textureIt->second;
     }
@@ -320,9 +314,9 @@ namespace dfv {
             uploadTexture(texture, data);
         }
 
-        auto [textureIt, isNewInsertion] = textures.insert_or_assign(name, texture);
-        if (!isNewInsertion)
-            std::cerr << "Warning: texture '" << name << "' was overwritten" << std::endl;
+        if (const auto it = textures.find(name); it != textures.end())
+            retireTexture(it->second);
+        auto textureIt = textures.insert_or_assign(name, texture).first;
 
         return &textureIt->second;
     }
@@ -351,13 +345,18 @@ namespace dfv {
         if (texMaterial)
             renderObj.material = texMaterial;
 
+        // The material may already sample another texture, which frames in flight may still be using
+        if (renderObj.material->textureSet != VK_NULL_HANDLE) {
+            retireObject([=, this, textureSet = renderObj.material->textureSet, sampler = renderObj.material->textureSampler] {
+                vkFreeDescriptorSets(device, descriptorPool, 1, &textureSet);
+                vkDestroySampler(device, sampler, nullptr);
+            });
+        }
+
         const VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(VK_FILTER_LINEAR);
         VkSampler blockySampler;
         vkCreateSampler(device, &samplerInfo, nullptr, &blockySampler);
-
-        mainDeletionQueue.pushFunction([=, this] {
-            vkDestroySampler(device, blockySampler, nullptr);
-        });
+        renderObj.material->textureSampler = blockySampler;
 
         // Allocate the descriptor set for the material set
         const VkDescriptorSetAllocateInfo allocInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -378,6 +377,26 @@ namespace dfv {
         vkUpdateDescriptorSets(device, 1, &textureSetWrite, 0, nullptr);
     }
 
+    void VulkanEngine::retireObject(DeletionQueue::DeletionFunc &&function) {
+        // Objects are retired between frames, so the last frame that may use one is the last one submitted. Its slot is
+        // waited upon again only after every frame before it, so the object is deleted then
+        frames[(frameNumber + MaxFramesInFlight - 1) % MaxFramesInFlight].deletionQueue.pushFunction(std::move(function));
+    }
+
+    void VulkanEngine::retireMesh(const Mesh &mesh) {
+        retireObject([=, this, vertexBuffer = mesh.vertexBuffer, indexBuffer = mesh.indexBuffer] {
+            vmaDestroyBuffer(allocator, vertexBuffer.buffer, vertexBuffer.allocation);
+            vmaDestroyBuffer(allocator, indexBuffer.buffer, indexBuffer.allocation);
+        });
+    }
+
+    void VulkanEngine::retireTexture(const Texture &texture) {
+        retireObject([=, this, imageView = texture.imageView, image = texture.image] {
+            vkDestroyImageView(device, imageView, nullptr);
+            vmaDestroyImage(allocator, image.image, image.allocation);
+        });
+    }
+
     RenderObject *VulkanEngine::getRenderObject(const RenderHandle handle) {
         return &renderObjects[handle];
     }
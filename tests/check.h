@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+#include <string_view>
+
+namespace dfv::test {
+    inline int failureCount = 0;
+
+    /**
+     * @brief Reports a failed check without stopping the test, so that a single run shows every failure.
+     */
+    inline void check(const bool condition, const std::string_view description) {
+        if (condition)
+            return;
+        std::cerr << "Check failed: " << description << std::endl;
+        failureCount++;
+    }
+
+    /**
+     * @return The exit code of the test, non-zero if any check failed.
+     */
+    inline int result() {
+        if (failureCount > 0)
+            std::cerr << failureCount << " checks failed" << std::endl;
+        return failureCount > 0 ? 1 : 0;
+    }
+} // namespace dfv::test
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+
+#include <flight_data/compressed_path.h>
+#include <flight_data/flight_track.h>
+#include <flight_data/synthetic_flight_data.h>
+
+#include "check.h"
+
+using namespace dfv;
+using dfv::test::check;
+
+namespace {
+    constexpr double Latitude = 45.5009309;
+
+    /**
+     * @brief Checks that decoding returns every sample within the fixed-point steps of the encoding.
+     */
+    void checkRoundTrip(const std::vector<FlightDataPoint> &points, const CompressedPath &path) {
+        check(path.size() == points.size(), "compressed path size");
+        check(path.startTime() == points.front().timestamp && std::abs(path.endTime() - points.back().timestamp) < 1e-3f,
+              "compressed path time range");
+
+        const auto decoded = path.decode();
+        float maxPositionError = 0.f;
+        float maxAngleError = 0.f;
+        for (size_t i = 0; i < points.size() && i < decoded.size(); i++) {
+            for (const auto &[original, restored] : {std::pair{points[i].timestamp, decoded[i].timestamp},
+                                                    std::pair{points[i].x, decoded[i].x},
+                                                    std::pair{points[i].y, decoded[i].y},
+                                                    std::pair{points[i].z, decoded[i].z}})
+                maxPositionError = std::max(maxPositionError, std::abs(original - restored));
+            for (const auto &[original, restored] : {std::pair{points[i].yaw, decoded[i].yaw},
+                                                    std::pair{points[i].pitch, decoded[i].pitch},
+                                                    std::pair{points[i].roll, decoded[i].roll}})
+                maxAngleError = std::max(maxAngleError, std::abs(original - restored));
+        }
+        check(decoded.size() == points.size(), "decoded sample count");
+        check(maxPositionError <= 0.5e-3f + 1e-4f, "decoded positions and timestamps within 1/1000");
+        check(maxAngleError <= 0.5e-4f + 1e-5f, "decoded angles within 1/10000 rad");
+    }
+
+    /**
+     * @brief Checks that lookups into the compressed path agree with the same lookups into a track.
+     */
+    void checkLookups(const std::vector<FlightDataPoint> &points, CompressedPath &path) {
+        const FlightTrack track{points, Latitude};
+
+        PlaybackCursor trackCursor{};
+        PlaybackCursor pathCursor{};
+        float maxPointError = 0.f;
+        float maxSpeedError = 0.f;
+        float maxDistanceError = 0.f;
+        for (float time = -1.f; time < points.back().timestamp + 1.f; time += 0.37f) {
+            const auto expected = track.interpolate(time, trackCursor);
+            const auto actual = path.interpolate(time, pathCursor);
+            maxPointError = std::max({maxPointError, std::abs(expected.x - actual.x), std::abs(expected.y - actual.y),
+                                      std::abs(expected.z - actual.z)});
+
+            const auto expectedChannels = track.interpolateChannels(time, trackCursor);
+            const auto actualChannels = path.interpolateChannels(time, pathCursor);
+            maxSpeedError = std::max(maxSpeedError, std::abs(expectedChannels.groundSpeed - actualChannels.groundSpeed));
+            maxDistanceError = std::max(maxDistanceError, std::abs(expectedChannels.distance - actualChannels.distance));
+        }
+        check(maxPointError < 2e-3f, "compressed interpolation matches the track");
+        check(maxSpeedError < 0.1f, "compressed ground speed matches the track");
+        check(maxDistanceError < 0.001f * track.distances().back(), "compressed distance matches the track");
+    }
+} // namespace
+
+int main() {
+    // Longer than a few blocks, with noise so that the differences take more than a byte
+    const auto points = SyntheticFlightData::generate({.duration = 600.f});
+    CompressedPath path{points, Latitude};
+
+    checkRoundTrip(points, path);
+    checkLookups(points, path);
+    check(path.encodedSize() < points.size() * sizeof(FlightDataPoint) / 2, "compressed path is less than half the size");
+
+    const CompressedPath empty{{}, Latitude};
+    check(empty.empty() && empty.decode().empty(), "empty compressed path");
+
+    return dfv::test::result();
+}
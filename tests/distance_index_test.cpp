@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <flight_data/distance_index.h>
+#include <flight_data/flight_track.h>
+#include <flight_data/synthetic_flight_data.h>
+
+#include "check.h"
+
+using namespace dfv;
+using dfv::test::check;
+
+namespace {
+    /**
+     * @brief Checks the distances the slider seeks with, built from the track and from the path as the visualizer does.
+     * @details The synthetic flight keeps a constant speed in meters, so the distance along it grows linearly with time
+     * at any latitude.
+     */
+    void checkDistances(const double latitude) {
+        const SyntheticFlightOptions options{.duration = 2000.f,
+                                             .speed = 15.f,
+                                             .altitudeProfile = AltitudeProfile::Constant,
+                                             .noise = 0.f,
+                                             .origin = {.lat = latitude, .lon = 9.1553888, .alt = 0.0}};
+        const auto points = SyntheticFlightData::generate(options);
+        const FlightTrack track{points, latitude};
+        const DistanceIndex fromTrack{track};
+        const DistanceIndex fromPath{points, latitude};
+        const auto at = " at latitude " + std::to_string(latitude);
+
+        check(std::abs(fromTrack.totalDistance() - fromPath.totalDistance()) < 1e-3f * fromTrack.totalDistance(),
+              "track and path distances agree" + at);
+        check(std::abs(fromTrack.totalDistance() / options.duration - options.speed) < 0.15f,
+              "total distance over duration" + at);
+
+        float maxDistanceError = 0.f;
+        float maxTimeError = 0.f;
+        for (float time = 0.f; time <= options.duration; time += 7.3f) {
+            const float distance = fromTrack.distanceAt(time);
+            maxDistanceError = std::max(maxDistanceError, std::abs(fromPath.distanceAt(time) - distance));
+            maxTimeError = std::max(maxTimeError, std::abs(fromTrack.timestampAt(distance) - time));
+        }
+        check(maxDistanceError < 1e-3f * fromTrack.totalDistance(), "distance at timestamp from track and path" + at);
+        check(maxTimeError < 0.01f, "timestamp at distance inverts distance at timestamp" + at);
+
+        // The slider's range covers the whole flight and seeks outside it are clamped
+        check(fromTrack.distanceAt(points.front().timestamp) == 0.f, "distance at the start" + at);
+        check(fromTrack.distanceAt(points.back().timestamp) == fromTrack.totalDistance(), "distance at the end" + at);
+        check(fromTrack.timestampAt(-1.f) == points.front().timestamp, "seek before the start" + at);
+        check(fromTrack.timestampAt(fromTrack.totalDistance() + 1.f) == points.back().timestamp, "seek past the end" + at);
+    }
+} // namespace
+
+int main() {
+    for (const double latitude : {0.0, 45.5, 70.0})
+        checkDistances(latitude);
+
+    return dfv::test::result();
+}
@@ -0,0 +1,76 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <flight_data/flight_alignment.h>
+#include <flight_data/geo_types.h>
+#include <flight_data/synthetic_flight_data.h>
+
+#include "check.h"
+
+using namespace dfv;
+using dfv::test::check;
+
+namespace {
+    constexpr double Latitude = 45.5009309;
+
+    /**
+     * @brief A level path, so that the only way to match a sample of a copy moved up is with the same sample.
+     */
+    std::vector<FlightDataPoint> syntheticPath() {
+        return SyntheticFlightData::generate({.duration = 300.f, .altitudeProfile = AltitudeProfile::Constant, .noise = 0.f});
+    }
+
+    /**
+     * @brief Checks that a path aligned with itself matches every sample with itself.
+     */
+    void checkSelfAlignment() {
+        const auto path = syntheticPath();
+        const auto alignment = alignPaths(path, path, Latitude);
+
+        check(alignment.timestamps.size() == path.size(), "self alignment covers every sample");
+        check(alignment.meanDeviation < 1e-4f, "self alignment mean deviation");
+        check(alignment.maxDeviation < 1e-4f, "self alignment max deviation");
+    }
+
+    /**
+     * @brief Checks that a copy of a path 10 m higher deviates from it by 10 m everywhere.
+     */
+    void checkVerticalOffset() {
+        const auto path = syntheticPath();
+        auto offsetPath = path;
+        for (auto &point : offsetPath)
+            point.y += 10.f;
+
+        const auto alignment = alignPaths(path, offsetPath, Latitude);
+
+        check(std::abs(alignment.meanDeviation - 10.f) < 1e-3f, "vertical offset mean deviation");
+        check(std::abs(alignment.maxDeviation - 10.f) < 1e-3f, "vertical offset max deviation");
+        check(!alignment.empty() && std::abs(alignment.deviationAt(150.f) - 10.f) < 1e-3f, "vertical offset deviation mid-flight");
+    }
+
+    /**
+     * @brief Checks that the deviation of a copy of a path 10 m further east is in meters.
+     * @details Where the path heads east, a sample can be matched with a closer sample of the copy further along, so
+     * only the largest deviation is the full offset, met where the path heads north or south.
+     */
+    void checkHorizontalOffset() {
+        const auto path = syntheticPath();
+        const UnitScale scale = unitScaleAt(Latitude);
+        auto offsetPath = path;
+        for (auto &point : offsetPath)
+            point.x += 10.f / scale.east;
+
+        const auto alignment = alignPaths(path, offsetPath, Latitude);
+
+        check(std::abs(alignment.maxDeviation - 10.f) < 1e-2f, "horizontal offset max deviation");
+    }
+} // namespace
+
+int main() {
+    checkSelfAlignment();
+    checkVerticalOffset();
+    checkHorizontalOffset();
+
+    return dfv::test::result();
+}
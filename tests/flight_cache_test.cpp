@@ -0,0 +1,95 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <flight_data/flight_cache.h>
+#include <flight_data/synthetic_flight_data.h>
+
+#include "check.h"
+
+using namespace dfv;
+using dfv::test::check;
+
+namespace {
+    /**
+     * @brief A directory of its own for the test files, removed when done.
+     */
+    struct TemporaryDirectory {
+        TemporaryDirectory()
+            : path(std::filesystem::temp_directory_path() / ("dfv_flight_cache_test_" + std::to_string(std::random_device{}()))) {
+            std::filesystem::create_directories(path);
+        }
+
+        ~TemporaryDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(path, error);
+        }
+
+        const std::filesystem::path path;
+    };
+
+    void writeFile(const std::filesystem::path &path, const std::string &contents) {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file << contents;
+    }
+
+    /**
+     * @brief Overwrites the version in the header of a cache file.
+     */
+    void writeVersion(const std::filesystem::path &path, const uint32_t version) {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(offsetof(FlightCache::Header, version));
+        file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+
+    ParsedFlight syntheticFlight() {
+        ParsedFlight flight{};
+        flight.points = SyntheticFlightData::generate({.duration = 120.f});
+        flight.initialPosition = {.lat = 45.5009309, .lon = 9.1553888, .alt = 120.0};
+        flight.summary.boundingBox = {.llLat = 45.49, .llLon = 9.15, .urLat = 45.51, .urLon = 9.16};
+        flight.summary.minimumAltitude = 0.f;
+        flight.summary.maximumAltitude = 120.f;
+        flight.skippedRows = 3;
+        return flight;
+    }
+} // namespace
+
+int main() {
+    const TemporaryDirectory directory;
+    const auto sourcePath = directory.path / "flight.csv";
+    writeFile(sourcePath, "not parsed, only its size and modification time matter");
+
+    const FlightCache cache{sourcePath};
+    const auto flight = syntheticFlight();
+    check(cache.store(flight), "cache is stored");
+
+    // Round trip
+    const auto loaded = cache.load();
+    check(loaded.has_value(), "stored cache loads");
+    if (loaded) {
+        check(loaded->points.size() == flight.points.size() &&
+                      std::memcmp(loaded->points.data(), flight.points.data(), flight.points.size() * sizeof(FlightDataPoint)) == 0,
+              "cached points are identical");
+        check(loaded->initialPosition.lat == flight.initialPosition.lat && loaded->initialPosition.lon == flight.initialPosition.lon,
+              "cached initial position");
+        check(loaded->summary.maximumAltitude == flight.summary.maximumAltitude && loaded->skippedRows == flight.skippedRows,
+              "cached summary");
+    }
+    const auto header = cache.loadHeader();
+    check(header && header->pointCount == flight.points.size() && header->endTimestamp == flight.points.back().timestamp,
+          "cached header");
+
+    // A cache written by another version of the layout is ignored
+    writeVersion(cache.path(), FlightCache::Version + 1);
+    check(!cache.load() && !cache.loadHeader(), "cache of another version is ignored");
+    writeVersion(cache.path(), FlightCache::Version);
+    check(cache.load().has_value(), "cache of the current version loads again");
+
+    // As is a cache of a source that changed since
+    writeFile(sourcePath, "a different source file, of a different size");
+    check(!cache.load() && !cache.loadHeader(), "cache of a changed source is ignored");
+
+    return dfv::test::result();
+}
@@ -0,0 +1,46 @@
+#include <cmath>
+#include <string>
+
+#include <flight_data/flight_track.h>
+#include <flight_data/synthetic_flight_data.h>
+
+#include "check.h"
+
+using namespace dfv;
+using dfv::test::check;
+
+namespace {
+    /**
+     * @brief Checks that the derived speed of a synthetic flight matches the speed it was generated with.
+     * @details The east units of the relative positions shrink with the latitude, so a speed computed in units instead
+     * of meters only matches at a single latitude.
+     */
+    void checkSyntheticSpeed(const double latitude) {
+        // A smooth, level flight over several periods of its figure, whose average speed is then the requested one
+        const SyntheticFlightOptions options{.duration = 20000.f,
+                                             .speed = 15.f,
+                                             .altitudeProfile = AltitudeProfile::Constant,
+                                             .noise = 0.f,
+                                             .origin = {.lat = latitude, .lon = 9.1553888, .alt = 0.0}};
+        const auto points = SyntheticFlightData::generate(options);
+        const FlightTrack track{points, latitude};
+
+        PlaybackCursor cursor{};
+        double speedSum = 0.0;
+        for (const auto &point : points)
+            speedSum += track.interpolateChannels(point.timestamp, cursor).groundSpeed;
+        const double averageSpeed = speedSum / static_cast<double>(points.size());
+        const double averageDistanceSpeed = track.distances().back() / options.duration;
+
+        const auto at = " at latitude " + std::to_string(latitude);
+        check(std::abs(averageSpeed - options.speed) < 0.15, "average ground speed" + at);
+        check(std::abs(averageDistanceSpeed - options.speed) < 0.15, "distance over duration" + at);
+    }
+} // namespace
+
+int main() {
+    for (const double latitude : {0.0, 30.0, 45.5, 60.0, 75.0, -50.0})
+        checkSyntheticSpeed(latitude);
+
+    return dfv::test::result();
+}